@@ -0,0 +1,724 @@
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "modular.h"
+
+//primes for Q and Z are drawn from [2^30, 2^31) so residues multiply in 64 bits
+#define CHECK_PRIME_LOW (1LL << 30)
+#define CHECK_MAX_ATTEMPTS 8
+
+//trial division for the smallest factor of a word-size modulus stops here
+#define CHECK_FACTOR_LIMIT (1LL << 20)
+
+//a prime is the first one at or after a uniform start, so none is drawn with
+//probability above the widest prime gap below 2^31 over 2^30
+#define CHECK_PRIME_GAP 292
+
+//values in Montgomery rings are drawn below 2^62 and below the modulus
+#define CHECK_MONT_BITS 62
+
+#define VEC_ZERO 2
+
+FastCheck* fast_check_create(double error, uint64_t seed) {
+    FastCheck* fc = calloc(1, sizeof(FastCheck));
+    if (!fc) return NULL;
+
+    fc->error = error;
+    fc->state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    return fc;
+}
+
+void fast_check_destroy(FastCheck* fc) {
+    if (!fc) return;
+
+    for (int i = 0; i < MAX_MODULES; i++) {
+        free(fc->sketches[i].values);
+        free(fc->sketches[i].limbs);
+    }
+    free(fc);
+}
+
+static uint64_t next_random(FastCheck* fc) {
+    uint64_t x = fc->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    fc->state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+//deterministic Miller-Rabin; these bases decide every n below 2^64
+static int is_prime(long long n) {
+    static const long long bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2) return 0;
+
+    long long d = n - 1;
+    int s = 0;
+    while (!(d & 1)) {
+        d >>= 1;
+        s++;
+    }
+
+    for (int i = 0; i < (int)(sizeof(bases) / sizeof(bases[0])); i++) {
+        long long a = bases[i] % n;
+        if (a == 0) continue;
+
+        long long x = 1, b = a;
+        for (long long e = d; e > 0; e >>= 1) {
+            if (e & 1) x = mod_mul(x, b, n);
+            b = mod_mul(b, b, n);
+        }
+
+        int witness = x != 1 && x != n - 1;
+        for (int r = 1; r < s && witness; r++) {
+            x = mod_mul(x, x, n);
+            if (x == n - 1) witness = 0;
+        }
+        if (witness) return 0;
+    }
+    return 1;
+}
+
+//n itself when n is prime; otherwise its smallest factor, or a lower bound on it
+//when there is none below CHECK_FACTOR_LIMIT
+static long long smallest_factor(long long n) {
+    for (long long d = 2; d * d <= n && d < CHECK_FACTOR_LIMIT; d++) {
+        if (n % d == 0) return d;
+    }
+    return (n < CHECK_FACTOR_LIMIT * CHECK_FACTOR_LIMIT || is_prime(n)) ? n : CHECK_FACTOR_LIMIT;
+}
+
+static int bit_length(unsigned long long x) {
+    int bits = 0;
+    while (x) {
+        bits++;
+        x >>= 1;
+    }
+    return bits;
+}
+
+static long long trial_prime(FastCheck* fc, int trial) {
+    while (fc->prime_count <= trial) {
+        long long n = CHECK_PRIME_LOW + (long long)(next_random(fc) % CHECK_PRIME_LOW);
+        while (smallest_factor(n) != n) n++;
+        fc->primes[fc->prime_count++] = n;
+    }
+    return fc->primes[trial];
+}
+
+static long long reduce(long long v, long long m) {
+    v %= m;
+    return v < 0 ? v + m : v;
+}
+
+static Module* generator_owner(Parser* p, const char* name, int* index) {
+    for (int i = 0; i < p->module_count; i++) {
+        Module* module = &p->modules[i];
+        for (int g = 0; g < module->generator_count; g++) {
+            if (strcmp(module->generators[g], name) == 0) {
+                *index = g;
+                return module;
+            }
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    Parser* p;
+    Module* module;
+    int mixed;
+    int unsupported;
+} Claim;
+
+//bits bounds the coefficients of numerator and denominator, as integer polynomials
+//in the generators and scalars, by their sum of absolute values
+typedef struct {
+    int vector;
+    int degree;
+    int division;
+    int bits;
+} Shape;
+
+static int number_bits(const Expr* e) {
+    size_t digits = strlen(e->name);
+    if (digits > 18) return 4 * (int)digits;
+    return bit_length((unsigned long long)e->number);
+}
+
+//a generator stands for the sum of its coordinates times the random functional
+static int generator_bits(const Module* module, int g) {
+    if (module->base_ring->mont) return 0;
+
+    unsigned long long sum = 0;
+    for (int j = 0; j < module->dimension; j++) {
+        long long x = coeff_get(&module->coeffs, g, j);
+        sum += (unsigned long long)(x < 0 ? -x : x);
+    }
+    return bit_length(sum);
+}
+
+static int add_vectors(int a, int b) {
+    if (a < 0 || b < 0) return -1;
+    if (a == VEC_ZERO) return b;
+    if (b == VEC_ZERO) return a;
+    return a == b ? a : -1;
+}
+
+//vector: 0 for scalars, 1 for linear in the generators, VEC_ZERO for the literal 0,
+//-1 for anything else; degree bounds numerator and denominator as one fraction
+static Shape analyze(Claim* c, Expr* e) {
+    Shape s = {-1, 0, 0, 0};
+    Shape a, b;
+    int index;
+
+    switch (e->kind) {
+        case EXPR_NUMBER:
+            s.vector = e->number == 0 ? VEC_ZERO : 0;
+            s.bits = number_bits(e);
+            return s;
+        case EXPR_VARIABLE: {
+            Module* owner = generator_owner(c->p, e->name, &index);
+            if (owner) {
+                if (c->module && owner != c->module) c->mixed = 1;
+                c->module = owner;
+            }
+            s.vector = owner ? 1 : 0;
+            s.degree = 1;
+            s.bits = owner ? generator_bits(owner, index) : 0;
+            return s;
+        }
+        case EXPR_NEG:
+            return analyze(c, e->left);
+        case EXPR_ADD: case EXPR_SUB: case EXPR_EQ:
+            a = analyze(c, e->left);
+            b = analyze(c, e->right);
+            s.vector = add_vectors(a.vector, b.vector);
+            s.division = a.division || b.division;
+            s.degree = s.division ? a.degree + b.degree : (a.degree > b.degree ? a.degree : b.degree);
+            s.bits = (s.division ? a.bits + b.bits : (a.bits > b.bits ? a.bits : b.bits)) + 1;
+            return s;
+        case EXPR_MUL:
+            a = analyze(c, e->left);
+            b = analyze(c, e->right);
+            if (a.vector >= 0 && b.vector >= 0) {
+                if (a.vector == VEC_ZERO || b.vector == VEC_ZERO) s.vector = VEC_ZERO;
+                else if (a.vector + b.vector <= 1) s.vector = a.vector + b.vector;
+            }
+            s.division = a.division || b.division;
+            s.degree = a.degree + b.degree;
+            s.bits = a.bits + b.bits;
+            return s;
+        case EXPR_DIV:
+            a = analyze(c, e->left);
+            b = analyze(c, e->right);
+            if (b.vector == 0) s.vector = a.vector;
+            s.division = 1;
+            s.degree = a.degree + b.degree;
+            s.bits = a.bits + b.bits;
+            return s;
+        default:
+            c->unsupported = 1;
+            return s;
+    }
+}
+
+//over GF(2) every trial at once: the generators times a matrix of random bits, one
+//column per trial
+static int gf2_sketch(FastCheck* fc, Module* module, int trials, long long* values) {
+    int k = module->generator_count;
+    GF2Matrix g, r, s;
+    if (gf2_matrix_from_coeffs(&g, &module->coeffs, k) != 0) return -1;
+    if (gf2_matrix_init(&r, module->dimension, trials) != 0) {
+        gf2_matrix_free(&g);
+        return -1;
+    }
+
+    for (int t = 0; t < trials; t++) {
+        for (int j = 0; j < module->dimension; j++) gf2_set(&r, j, t, (int)(next_random(fc) & 1));
+    }
+
+    int status = gf2_multiply(&s, &g, &r, gf2_xor_function());
+    if (status == 0) {
+        for (int t = 0; t < trials; t++) {
+            for (int i = 0; i < k; i++) values[(size_t)t * k + i] = gf2_get(&s, i, t);
+        }
+        gf2_matrix_free(&s);
+    }
+    gf2_matrix_free(&g);
+    gf2_matrix_free(&r);
+    return status;
+}
+
+//s_g = g . r for a random r, one row per trial; built once per module and reused
+static const long long* module_sketch(FastCheck* fc, Parser* p, Module* module, int trials,
+                                      long long fixed) {
+    CheckSketch* sketch = &fc->sketches[module - p->modules];
+    int k = module->generator_count;
+    if (sketch->values && sketch->generator_count == k && sketch->trials >= trials) {
+        return sketch->values;
+    }
+
+    long long* values = malloc(sizeof(long long) * ((size_t)trials * k + 1));
+    long long* r = fixed == 2 ? NULL : malloc(sizeof(long long) * module->dimension);
+    int failed = !values || (fixed != 2 && !r);
+    if (!failed && fixed == 2) failed = gf2_sketch(fc, module, trials, values) != 0;
+    if (failed) {
+        free(values);
+        free(r);
+        return NULL;
+    }
+
+    for (int t = 0; r && t < trials; t++) {
+        long long m = fixed ? fixed : trial_prime(fc, t);
+        for (int j = 0; j < module->dimension; j++) r[j] = (long long)(next_random(fc) % (uint64_t)m);
+
+        for (int g = 0; g < k; g++) {
+            long long s = 0;
+            for (int j = 0; j < module->dimension; j++) {
+                long long x = reduce(coeff_get(&module->coeffs, g, j), m);
+                s = mod_add(s, mod_mul(x, r[j], m), m);
+            }
+            values[(size_t)t * k + g] = s;
+        }
+    }
+    free(r);
+
+    free(sketch->values);
+    sketch->values = values;
+    sketch->generator_count = k;
+    sketch->trials = trials;
+    return values;
+}
+
+static int mont_sample_bits(const MontContext* mont) {
+    return mont->bits - 1 < CHECK_MONT_BITS ? mont->bits - 1 : CHECK_MONT_BITS;
+}
+
+//the same functionals over a Montgomery ring, one trial of limbs per generator
+static const limb_t* mont_sketch(FastCheck* fc, Parser* p, Module* module, int trials) {
+    CheckSketch* sketch = &fc->sketches[module - p->modules];
+    const MontContext* mont = module->base_ring->mont;
+    int k = module->generator_count;
+    if (sketch->limbs && sketch->generator_count == k && sketch->trials >= trials) {
+        return sketch->limbs;
+    }
+
+    size_t width = (size_t)mont->limbs;
+    limb_t* limbs = malloc(sizeof(limb_t) * ((size_t)trials * k * width + 1));
+    limb_t* r = malloc(sizeof(limb_t) * module->dimension * width);
+    if (!limbs || !r) {
+        free(limbs);
+        free(r);
+        return NULL;
+    }
+
+    uint64_t mask = ((uint64_t)1 << mont_sample_bits(mont)) - 1;
+    for (int t = 0; t < trials; t++) {
+        for (int j = 0; j < module->dimension; j++) {
+            mont_from_int(mont, r + j * width, (long long)(next_random(fc) & mask));
+        }
+
+        for (int g = 0; g < k; g++) {
+            limb_t* s = limbs + ((size_t)t * k + g) * width;
+            limb_t x[MONT_MAX_LIMBS];
+            mont_zero(mont, s);
+            for (int j = 0; j < module->dimension; j++) {
+                mont_mul(mont, x, coeff_limbs(&module->coeffs, g, j), r + j * width);
+                mont_add(mont, s, s, x);
+            }
+        }
+    }
+    free(r);
+
+    free(sketch->limbs);
+    sketch->limbs = limbs;
+    sketch->generator_count = k;
+    sketch->trials = trials;
+    return limbs;
+}
+
+static uint64_t name_hash(const char* name, uint64_t salt) {
+    uint64_t h = salt;
+    for (const char* c = name; *c; c++) {
+        h = (h ^ (unsigned char)*c) * 0x100000001B3ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+typedef struct {
+    Parser* p;
+    Module* module;
+    const long long* sketch;
+    long long modulus;
+    uint64_t salt;
+} Point;
+
+//generators take their sketch value, other names a value hashed from the salt
+static int point_lookup(void* ctx, const char* name, long long* value) {
+    Point* point = ctx;
+    int index;
+    if (point->module && generator_owner(point->p, name, &index) == point->module) {
+        *value = point->sketch[index];
+        return 0;
+    }
+
+    *value = (long long)(name_hash(name, point->salt) % (uint64_t)point->modulus);
+    return 0;
+}
+
+typedef struct {
+    Parser* p;
+    Module* module;
+    const MontContext* mont;
+    const limb_t* sketch;
+    uint64_t salt;
+} MontPoint;
+
+//evaluates one side of a relation in the ring; -1 when a denominator vanishes
+static int mont_eval(MontPoint* point, const Expr* e, limb_t* out) {
+    const MontContext* mont = point->mont;
+    limb_t a[MONT_MAX_LIMBS], b[MONT_MAX_LIMBS];
+    int index;
+
+    switch (e->kind) {
+        case EXPR_NUMBER:
+            mont_from_decimal(mont, out, e->name, strlen(e->name));
+            return 0;
+        case EXPR_VARIABLE:
+            if (point->module && generator_owner(point->p, e->name, &index) == point->module) {
+                memcpy(out, point->sketch + (size_t)index * mont->limbs, sizeof(limb_t) * mont->limbs);
+            } else {
+                uint64_t mask = ((uint64_t)1 << mont_sample_bits(mont)) - 1;
+                mont_from_int(mont, out, (long long)(name_hash(e->name, point->salt) & mask));
+            }
+            return 0;
+        case EXPR_NEG:
+            if (mont_eval(point, e->left, a) != 0) return -1;
+            mont_zero(mont, b);
+            mont_sub(mont, out, b, a);
+            return 0;
+        case EXPR_ADD: case EXPR_SUB: case EXPR_MUL: case EXPR_DIV:
+            if (mont_eval(point, e->left, a) != 0 || mont_eval(point, e->right, b) != 0) return -1;
+            if (e->kind == EXPR_ADD) mont_add(mont, out, a, b);
+            else if (e->kind == EXPR_SUB) mont_sub(mont, out, a, b);
+            else if (e->kind == EXPR_MUL) mont_mul(mont, out, a, b);
+            else if (mont_inverse(mont, b, b) != 0) return -1;
+            else mont_mul(mont, out, a, b);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+static int append(char** buf, size_t* len, size_t* cap, const char* text) {
+    size_t n = strlen(text);
+    if (*len + n + 1 > *cap) {
+        size_t grown = (*len + n + 1) * 2;
+        char* next = realloc(*buf, grown);
+        if (!next) return -1;
+        *buf = next;
+        *cap = grown;
+    }
+    memcpy(*buf + *len, text, n + 1);
+    *len += n;
+    return 0;
+}
+
+//generator term i of a linear form as a row of the module's coefficients
+static int term_row(Parser* p, const LinearForm* form, int i) {
+    int index = 0;
+    generator_owner(p, form->terms[i].var, &index);
+    return index;
+}
+
+//the canonicalized relation no longer knows its left side, so the residual is
+//printed with the sign that makes its first nonzero coordinate the smaller one
+static char* exact_residual(Module* module, const LinearForm* form, Parser* p, int* ok) {
+    const Ring* ring = module->base_ring;
+    const MontContext* mont = ring->mont;
+    int n = module->dimension;
+    *ok = 0;
+
+    limb_t* limbs = mont ? calloc((size_t)n * mont->limbs, sizeof(limb_t)) : NULL;
+    long long* small = calloc(n, sizeof(long long));
+    Value* big = calloc(n, sizeof(Value));
+    if ((mont && !limbs) || !small || !big) {
+        free(limbs);
+        free(small);
+        free(big);
+        return NULL;
+    }
+
+    int first = -1;
+    for (int j = 0; j < n; j++) {
+        if (mont) {
+            limb_t* sum = limbs + (size_t)j * mont->limbs;
+            limb_t c[MONT_MAX_LIMBS], t[MONT_MAX_LIMBS];
+            mont_zero(mont, sum);
+            for (int i = 0; i < form->term_count; i++) {
+                mont_from_value(mont, c, form->terms[i].coeff);
+                mont_mul(mont, t, c, coeff_limbs(&module->coeffs, term_row(p, form, i), j));
+                mont_add(mont, sum, sum, t);
+            }
+            if (first < 0 && !mont_is_zero(mont, sum)) first = j;
+        } else if (ring->is_finite_field) {
+            long long m = ring->modulus;
+            for (int i = 0; i < form->term_count; i++) {
+                long long x = coeff_get(&module->coeffs, term_row(p, form, i), j);
+                small[j] = mod_add(small[j], mod_mul(value_mod_long(form->terms[i].coeff, m), x, m), m);
+            }
+            if (first < 0 && small[j]) first = j;
+        } else {
+            big[j] = value_from_fixnum(0);
+            for (int i = 0; i < form->term_count; i++) {
+                Value x = value_from_long(coeff_get(&module->coeffs, term_row(p, form, i), j));
+                Value t = value_mul(form->terms[i].coeff, x);
+                Value next = value_add(big[j], t);
+                value_release(x);
+                value_release(t);
+                value_release(big[j]);
+                big[j] = next;
+            }
+            if (first < 0 && value_sign(big[j]) != 0) first = j;
+        }
+    }
+
+    char* buf = NULL;
+    size_t len = 0, cap = 0;
+    size_t size = mont ? (size_t)mont->limbs * 20 + 2 : 0;
+    char* text = mont ? malloc(size) : NULL;
+    char* other = mont ? malloc(size) : NULL;
+    int negate = 0;
+    *ok = !mont || (text && other);
+
+    if (*ok && first >= 0) {
+        if (mont) {
+            limb_t zero[MONT_MAX_LIMBS], t[MONT_MAX_LIMBS];
+            limb_t* x = limbs + (size_t)first * mont->limbs;
+            mont_zero(mont, zero);
+            mont_sub(mont, t, zero, x);
+            *ok = mont_to_decimal(mont, x, text, size) == 0 && mont_to_decimal(mont, t, other, size) == 0;
+            negate = strlen(other) < strlen(text) ||
+                     (strlen(other) == strlen(text) && strcmp(other, text) < 0);
+        } else if (ring->is_finite_field) {
+            negate = small[first] > ring->modulus - small[first];
+        } else {
+            negate = value_sign(big[first]) < 0;
+        }
+    }
+
+    for (int j = 0; j < n && *ok && first >= 0; j++) {
+        char digits[32];
+        char* owned = NULL;
+        const char* entry = digits;
+
+        if (mont) {
+            limb_t zero[MONT_MAX_LIMBS], t[MONT_MAX_LIMBS];
+            limb_t* x = limbs + (size_t)j * mont->limbs;
+            mont_zero(mont, zero);
+            if (negate) mont_sub(mont, t, zero, x);
+            *ok = mont_to_decimal(mont, negate ? t : x, text, size) == 0;
+            entry = text;
+        } else if (ring->is_finite_field) {
+            long long x = negate && small[j] ? ring->modulus - small[j] : small[j];
+            snprintf(digits, sizeof(digits), "%lld", x);
+        } else {
+            Value x = negate ? value_neg(big[j]) : value_copy(big[j]);
+            owned = value_to_string(x);
+            value_release(x);
+            entry = owned;
+            *ok = owned != NULL;
+        }
+
+        if (*ok) {
+            *ok = append(&buf, &len, &cap, j == 0 ? "(" : ", ") == 0 &&
+                  append(&buf, &len, &cap, entry) == 0;
+        }
+        free(owned);
+    }
+    if (*ok && first >= 0) *ok = append(&buf, &len, &cap, ")") == 0;
+
+    if (!mont && !ring->is_finite_field) {
+        for (int j = 0; j < n; j++) value_release(big[j]);
+    }
+    free(limbs);
+    free(small);
+    free(big);
+    free(text);
+    free(other);
+
+    if (!*ok || first < 0) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+//1 holds, 0 fails (reported), -1 when the relation is not linear
+static int exact_check(FastCheck* fc, Parser* p, Claim* c, Expr* relation) {
+    const LinearForm* form = expr_normalize(p->exprs, relation);
+    if (!form) return -1;
+
+    if (!c->module) {
+        if (form->term_count == 0 && value_sign(form->constant) == 0) return 1;
+        fprintf(p->out, "  => fails: the two sides differ\n");
+        fc->failed++;
+        return 0;
+    }
+
+    int ok;
+    char* residual = exact_residual(c->module, form, p, &ok);
+    if (!ok) return -1;
+    if (!residual) return 1;
+
+    fprintf(p->out, "  => fails: the sides differ by %s in %s\n", residual, c->module->name);
+    free(residual);
+    fc->failed++;
+    return 0;
+}
+
+static void exact_fallback(FastCheck* fc, Parser* p, Claim* c, Expr* relation) {
+    int status = exact_check(fc, p, c, relation);
+    if (status == 1) {
+        fprintf(p->out, "  => holds (exact)\n");
+        fc->held++;
+    } else if (status < 0) {
+        fprintf(p->out, "  => unchecked: no error bound applies and the relation is not linear\n");
+        fc->unchecked++;
+    }
+}
+
+void fast_check_relation(FastCheck* fc, Parser* p, Expr* relation) {
+    if (!fc || !p) return;
+
+    if (!relation) {
+        fprintf(p->out, "  => unchecked: not an expression over generators and scalars\n");
+        fc->unchecked++;
+        return;
+    }
+
+    Claim c = {p, NULL, 0, 0};
+    Shape shape = analyze(&c, relation);
+    if (c.unsupported) {
+        fprintf(p->out, "  => unchecked: morphisms, calls and comparisons are not modelled\n");
+        fc->unchecked++;
+        return;
+    }
+    if (c.mixed || shape.vector < 0) {
+        fprintf(p->out, "  => unchecked: not an identity in a single module\n");
+        fc->unchecked++;
+        return;
+    }
+
+    //per-trial error: degree over the size of the sample set (Schwartz-Zippel), plus for
+    //Q and Z the chance that the prime divides every coefficient of the nonzero
+    //difference; those are below 2^bits, so at most bits/30 primes of [2^30, 2^31) do
+    const Ring* ring = c.module ? c.module->base_ring : NULL;
+    const MontContext* mont = ring ? ring->mont : NULL;
+    long long fixed = 0;
+    double per_trial = 1.0;
+    if (mont) {
+        //Fermat inversion of 2 fails for most composite moduli, which have no such bound
+        limb_t two[MONT_MAX_LIMBS];
+        mont_from_int(mont, two, 2);
+        if (mont_inverse(mont, two, two) == 0) {
+            per_trial = (double)shape.degree / (double)((uint64_t)1 << mont_sample_bits(mont));
+        }
+    } else if (ring && ring->is_finite_field) {
+        fixed = ring->modulus;
+        long long q = smallest_factor(fixed);
+        if (q == fixed) per_trial = (double)shape.degree / (double)fixed;
+        else if (shape.degree <= 1) per_trial = 1.0 / (double)q;
+    } else {
+        double divisors = (double)((shape.bits + 29) / 30);
+        per_trial = (shape.degree + divisors * CHECK_PRIME_GAP) / (double)CHECK_PRIME_LOW;
+    }
+
+    int trials = 0;
+    double bound = 1.0;
+    while (per_trial < 1.0 && bound > fc->error && trials <= CHECK_MAX_TRIALS) {
+        bound *= per_trial;
+        trials++;
+    }
+    if (per_trial >= 1.0 || trials > CHECK_MAX_TRIALS || shape.degree == 0) {
+        exact_fallback(fc, p, &c, relation);
+        return;
+    }
+
+    const long long* sketch = NULL;
+    const limb_t* limbs = NULL;
+    if (c.module) {
+        if (mont) limbs = mont_sketch(fc, p, c.module, trials);
+        else sketch = module_sketch(fc, p, c.module, trials, fixed);
+        if (!sketch && !limbs) {
+            exact_fallback(fc, p, &c, relation);
+            return;
+        }
+    }
+
+    Expr* left = relation->kind == EXPR_EQ ? relation->left : relation;
+    Expr* right = relation->kind == EXPR_EQ ? relation->right : NULL;
+
+    int violated = 0, evaluated = 1;
+    long long modulus = 0;
+    for (int t = 0; mont && t < trials && !violated && evaluated; t++) {
+        MontPoint point = {p, c.module, mont, limbs + (size_t)t * c.module->generator_count * mont->limbs, 0};
+
+        evaluated = 0;
+        for (int attempt = 0; attempt < CHECK_MAX_ATTEMPTS && !evaluated; attempt++) {
+            limb_t a[MONT_MAX_LIMBS], b[MONT_MAX_LIMBS];
+            point.salt = next_random(fc);
+            mont_zero(mont, b);
+            if (mont_eval(&point, left, a) == 0 && (!right || mont_eval(&point, right, b) == 0)) {
+                evaluated = 1;
+                violated = !mont_equal(mont, a, b);
+            }
+        }
+    }
+
+    for (int t = 0; !mont && t < trials && !violated && evaluated; t++) {
+        Point point = {p, c.module, sketch ? sketch + (size_t)t * c.module->generator_count : NULL,
+                       fixed ? fixed : trial_prime(fc, t), 0};
+        modulus = point.modulus;
+
+        //a vanishing denominator says nothing; redraw the scalar values
+        evaluated = 0;
+        for (int attempt = 0; attempt < CHECK_MAX_ATTEMPTS && !evaluated; attempt++) {
+            point.salt = next_random(fc);
+            expr_pool_bind(p->exprs, point_lookup, &point, point.modulus);
+
+            long long a, b = 0;
+            if (expr_eval(p->exprs, left, &a) == 0 && (!right || expr_eval(p->exprs, right, &b) == 0)) {
+                evaluated = 1;
+                violated = a != b;
+            }
+        }
+    }
+    expr_pool_bind(p->exprs, NULL, NULL, 0);
+
+    if (!evaluated) {
+        exact_fallback(fc, p, &c, relation);
+    } else if (violated) {
+        //a nonzero residue is proof; solve exactly to say where it fails
+        int status = exact_check(fc, p, &c, relation);
+        if (status == 1) {
+            fprintf(p->out, "  => holds (exact)\n");
+            fc->held++;
+        } else if (status < 0) {
+            if (mont) fprintf(p->out, "  => fails: the sides differ at a random point of %s\n", ring->name);
+            else fprintf(p->out, "  => fails: the sides differ at a random point modulo %lld\n", modulus);
+            fc->failed++;
+        }
+    } else {
+        fprintf(p->out, "  => holds (fast check, %d trial(s), error <= %.1e)\n", trials, bound);
+        fc->held++;
+    }
+}
+
+void fast_check_report(const FastCheck* fc, FILE* out) {
+    if (!fc || !out) return;
+
+    fprintf(out, "Fast check: %d held, %d failed, %d unchecked (error probability %.1e per relation)\n",
+            fc->held, fc->failed, fc->unchecked, fc->error);
+}
@@ -0,0 +1,43 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "parser.h"
+
+#define CHECK_DEFAULT_ERROR 1e-9
+#define CHECK_MAX_TRIALS 128
+
+//generator images under the random functionals of each trial; Montgomery
+//rings keep them as limbs instead
+typedef struct {
+    int generator_count;
+    int trials;
+    long long* values;
+    limb_t* limbs;
+} CheckSketch;
+
+//randomized verification of relations in place of solving them
+struct FastCheck {
+    double error;
+    uint64_t state;
+
+    //moduli drawn for the trials over Q and Z, shared by every relation
+    long long primes[CHECK_MAX_TRIALS];
+    int prime_count;
+    CheckSketch sketches[MAX_MODULES];
+
+    int held;
+    int failed;
+    int unchecked;
+};
+
+typedef struct FastCheck FastCheck;
+
+FastCheck* fast_check_create(double error, uint64_t seed);
+void fast_check_destroy(FastCheck* fc);
+
+void fast_check_relation(FastCheck* fc, Parser* p, Expr* relation);
+void fast_check_report(const FastCheck* fc, FILE* out);
+
+#endif
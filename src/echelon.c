@@ -0,0 +1,477 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "echelon.h"
+#include "modular.h"
+
+static Rational rational_zero(void) {
+    return rational_from_value(value_from_fixnum(0));
+}
+
+static int rational_is_zero(Rational r) {
+    return value_sign(r.num) == 0;
+}
+
+static Rational* q_row(const Echelon* e, int row) {
+    return e->q + (size_t)row * e->cols;
+}
+
+int echelon_init(Echelon* e, int cols, long long modulus, const MontContext* mont) {
+    if (!e || cols <= 0) return -1;
+
+    memset(e, 0, sizeof(*e));
+    e->cols = cols;
+    e->modulus = mont ? 0 : modulus;
+    e->mont = mont;
+
+    e->pivot_col = malloc(sizeof(int) * cols);
+    e->pivot_row = malloc(sizeof(int) * cols);
+    if (!e->pivot_col || !e->pivot_row) {
+        echelon_free(e);
+        return -1;
+    }
+    for (int c = 0; c < cols; c++) e->pivot_row[c] = -1;
+
+    int status;
+    if (mont) {
+        status = coeff_matrix_init(&e->rows, cols + 1, cols, mont->limbs * (int)sizeof(limb_t), 0);
+    } else if (modulus == 2) {
+        status = gf2_matrix_init(&e->bits, cols + 1, cols);
+        e->xor_row = gf2_xor_function();
+    } else if (modulus > 0) {
+        status = coeff_matrix_init(&e->rows, cols + 1, cols, coeff_width_for_modulus(modulus), 0);
+    } else {
+        e->q = malloc(sizeof(Rational) * (size_t)(cols + 1) * cols);
+        status = e->q ? 0 : -1;
+        for (size_t i = 0; e->q && i < (size_t)(cols + 1) * cols; i++) e->q[i] = rational_zero();
+    }
+
+    if (status != 0) {
+        echelon_free(e);
+        return -1;
+    }
+    return 0;
+}
+
+void echelon_free(Echelon* e) {
+    if (!e) return;
+
+    if (e->q) {
+        for (size_t i = 0; i < (size_t)(e->cols + 1) * e->cols; i++) rational_release(e->q[i]);
+        free(e->q);
+    }
+    coeff_matrix_free(&e->rows);
+    gf2_matrix_free(&e->bits);
+    free(e->pivot_col);
+    free(e->pivot_row);
+    memset(e, 0, sizeof(*e));
+}
+
+static void load_entry(Echelon* e, int j, Value v) {
+    int s = e->cols;
+    if (e->mont) {
+        mont_from_value(e->mont, coeff_limbs(&e->rows, s, j), v);
+    } else if (e->modulus > 0) {
+        long long r = value_mod_long(v, e->modulus);
+        if (e->modulus == 2) gf2_set(&e->bits, s, j, (int)r);
+        else coeff_set(&e->rows, s, j, r);
+    } else {
+        rational_release(q_row(e, s)[j]);
+        q_row(e, s)[j] = rational_from_value(v);
+    }
+}
+
+static void load_scratch(Echelon* e, const Value* coeffs) {
+    for (int j = 0; j < e->cols; j++) {
+        load_entry(e, j, coeffs[j]);
+    }
+}
+
+//dst -= f * src over the columns of one stored or scratch row
+static void subtract_row(Echelon* e, int dst, int src, int pivot) {
+    if (e->mont) {
+        const MontContext* mont = e->mont;
+        limb_t f[MONT_MAX_LIMBS];
+        limb_t t[MONT_MAX_LIMBS];
+        memcpy(f, coeff_limbs(&e->rows, dst, pivot), sizeof(limb_t) * mont->limbs);
+        if (mont_is_zero(mont, f)) return;
+
+        for (int j = 0; j < e->cols; j++) {
+            limb_t* x = coeff_limbs(&e->rows, dst, j);
+            mont_mul(mont, t, f, coeff_limbs(&e->rows, src, j));
+            mont_sub(mont, x, x, t);
+        }
+    } else if (e->modulus == 2) {
+        if (gf2_get(&e->bits, dst, pivot)) {
+            e->xor_row(gf2_row(&e->bits, dst), gf2_row(&e->bits, src), e->bits.words);
+        }
+    } else if (e->modulus > 0) {
+        long long p = e->modulus;
+        long long f = coeff_get(&e->rows, dst, pivot);
+        if (!f) return;
+
+        for (int j = 0; j < e->cols; j++) {
+            long long t = mod_mul(f, coeff_get(&e->rows, src, j), p);
+            coeff_set(&e->rows, dst, j, mod_sub(coeff_get(&e->rows, dst, j), t, p));
+        }
+    } else {
+        Rational* x = q_row(e, dst);
+        Rational* y = q_row(e, src);
+        if (rational_is_zero(x[pivot])) return;
+
+        Rational f = rational_copy(x[pivot]);
+        for (int j = 0; j < e->cols; j++) {
+            if (rational_is_zero(y[j])) continue;
+            Rational t = rational_mul(f, y[j]);
+            Rational d = rational_sub(x[j], t);
+            rational_release(t);
+            rational_release(x[j]);
+            x[j] = d;
+        }
+        rational_release(f);
+    }
+}
+
+//stored rows are zero in every other pivot column, so one pass is enough
+static void reduce_scratch(Echelon* e) {
+    for (int r = 0; r < e->rank; r++) {
+        subtract_row(e, e->cols, r, e->pivot_col[r]);
+    }
+}
+
+//picks the pivot of the reduced scratch row and scales it to one;
+//returns 0 when the row vanished, -1 when no entry is invertible
+static int normalize_scratch(Echelon* e, int* pivot) {
+    int s = e->cols;
+    int nonzero = 0;
+
+    for (int c = 0; c < e->cols; c++) {
+        if (e->mont) {
+            limb_t inv[MONT_MAX_LIMBS];
+            limb_t* x = coeff_limbs(&e->rows, s, c);
+            if (mont_is_zero(e->mont, x)) continue;
+            nonzero = 1;
+            if (mont_inverse(e->mont, inv, x) != 0) continue;
+            for (int j = 0; j < e->cols; j++) {
+                limb_t* y = coeff_limbs(&e->rows, s, j);
+                mont_mul(e->mont, y, y, inv);
+            }
+        } else if (e->modulus == 2) {
+            if (!gf2_get(&e->bits, s, c)) continue;
+        } else if (e->modulus > 0) {
+            long long x = coeff_get(&e->rows, s, c);
+            if (!x) continue;
+            nonzero = 1;
+            long long inv = mod_inverse(x, e->modulus);
+            if (!inv) continue;
+            for (int j = 0; j < e->cols; j++) {
+                coeff_set(&e->rows, s, j, mod_mul(coeff_get(&e->rows, s, j), inv, e->modulus));
+            }
+        } else {
+            Rational* x = q_row(e, s);
+            if (rational_is_zero(x[c])) continue;
+            Rational one = rational_from_value(value_from_fixnum(1));
+            Rational inv;
+            rational_div(one, x[c], &inv);
+            for (int j = 0; j < e->cols; j++) {
+                Rational y = rational_mul(x[j], inv);
+                rational_release(x[j]);
+                x[j] = y;
+            }
+            rational_release(inv);
+        }
+
+        *pivot = c;
+        return 1;
+    }
+    return nonzero ? -1 : 0;
+}
+
+static void copy_row(Echelon* e, int dst, int src) {
+    if (e->modulus == 2 && !e->mont) {
+        memcpy(gf2_row(&e->bits, dst), gf2_row(&e->bits, src), sizeof(uint64_t) * e->bits.words);
+    } else if (e->q) {
+        for (int j = 0; j < e->cols; j++) {
+            rational_release(q_row(e, dst)[j]);
+            q_row(e, dst)[j] = rational_copy(q_row(e, src)[j]);
+        }
+    } else {
+        memcpy(coeff_row(&e->rows, dst), coeff_row(&e->rows, src), e->rows.stride);
+    }
+}
+
+//returns 1 if the relation raised the rank, 0 if it was already implied,
+//-1 if over a composite modulus none of its remaining coefficients is a unit
+int echelon_add(Echelon* e, const Value* coeffs) {
+    if (!e || !coeffs) return -1;
+
+    load_scratch(e, coeffs);
+    reduce_scratch(e);
+
+    int pivot;
+    int status = normalize_scratch(e, &pivot);
+    if (status <= 0) return status;
+
+    //keep the form reduced: clear the new pivot column from the older rows
+    for (int r = 0; r < e->rank; r++) {
+        subtract_row(e, r, e->cols, pivot);
+    }
+
+    copy_row(e, e->rank, e->cols);
+    e->pivot_col[e->rank] = pivot;
+    e->pivot_row[pivot] = e->rank;
+    e->rank++;
+    return 1;
+}
+
+static int append(char** buf, size_t* len, size_t* cap, const char* text) {
+    size_t n = strlen(text);
+    if (*len + n + 1 > *cap) {
+        size_t grown = (*len + n + 1) * 2;
+        char* next = realloc(*buf, grown);
+        if (!next) return -1;
+        *buf = next;
+        *cap = grown;
+    }
+    memcpy(*buf + *len, text, n + 1);
+    *len += n;
+    return 0;
+}
+
+//canonical representative of a combination of the columns modulo the stored rows
+char* echelon_normal_form(Echelon* e, const long long* coeffs, const char* const* names) {
+    if (!e || !coeffs || !names) return NULL;
+
+    for (int j = 0; j < e->cols; j++) {
+        Value v = value_from_long(coeffs[j]);
+        load_entry(e, j, v);
+        value_release(v);
+    }
+    reduce_scratch(e);
+
+    int s = e->cols;
+    char* buf = NULL;
+    size_t len = 0, cap = 0;
+    int terms = 0;
+
+    for (int j = 0; j < e->cols; j++) {
+        char small[32];
+        char* text = NULL;
+        const char* coeff = small;
+
+        if (e->mont) {
+            const limb_t* x = coeff_limbs(&e->rows, s, j);
+            if (mont_is_zero(e->mont, x)) continue;
+            size_t size = (size_t)e->mont->limbs * 20 + 2;
+            text = malloc(size);
+            if (!text || mont_to_decimal(e->mont, x, text, size) != 0) {
+                free(text);
+                free(buf);
+                return NULL;
+            }
+            coeff = text;
+        } else if (e->modulus == 2) {
+            if (!gf2_get(&e->bits, s, j)) continue;
+            strcpy(small, "1");
+        } else if (e->modulus > 0) {
+            long long x = coeff_get(&e->rows, s, j);
+            if (!x) continue;
+            snprintf(small, sizeof(small), "%lld", x);
+        } else {
+            Rational x = q_row(e, s)[j];
+            if (rational_is_zero(x)) continue;
+            text = rational_to_string(x);
+            if (!text) {
+                free(buf);
+                return NULL;
+            }
+            coeff = text;
+        }
+
+        int ok = (terms == 0 || append(&buf, &len, &cap, " + ") == 0) &&
+                 (strcmp(coeff, "1") == 0 ||
+                  (append(&buf, &len, &cap, coeff) == 0 && append(&buf, &len, &cap, "*") == 0)) &&
+                 append(&buf, &len, &cap, names[j]) == 0;
+        free(text);
+        if (!ok) {
+            free(buf);
+            return NULL;
+        }
+        terms++;
+    }
+
+    if (terms == 0 && append(&buf, &len, &cap, "0") != 0) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+typedef struct {
+    unsigned char* data;
+    size_t len;
+    size_t cap;
+    int failed;
+} Bytes;
+
+static void put_bytes(Bytes* b, const void* data, size_t n) {
+    if (b->failed) return;
+    if (b->len + n > b->cap) {
+        size_t grown = (b->len + n) * 2;
+        unsigned char* next = realloc(b->data, grown);
+        if (!next) {
+            b->failed = 1;
+            return;
+        }
+        b->data = next;
+        b->cap = grown;
+    }
+    memcpy(b->data + b->len, data, n);
+    b->len += n;
+}
+
+static void put_int(Bytes* b, int32_t value) {
+    put_bytes(b, &value, sizeof(value));
+}
+
+static void put_value(Bytes* b, Value v) {
+    char* text = value_to_string(v);
+    put_bytes(b, text, strlen(text) + 1);
+    free(text);
+}
+
+//stored rows in order, each after its pivot column; rationals are written as text
+unsigned char* echelon_encode(const Echelon* e, size_t* len) {
+    if (!e || !len) return NULL;
+
+    Bytes b = {NULL, 0, 0, 0};
+    put_int(&b, e->cols);
+    put_int(&b, e->rank);
+
+    for (int r = 0; r < e->rank; r++) {
+        put_int(&b, e->pivot_col[r]);
+        if (e->q) {
+            for (int j = 0; j < e->cols; j++) {
+                put_value(&b, q_row(e, r)[j].num);
+                put_value(&b, q_row(e, r)[j].den);
+            }
+        } else if (e->modulus == 2 && !e->mont) {
+            put_bytes(&b, gf2_row(&e->bits, r), sizeof(uint64_t) * e->bits.words);
+        } else {
+            put_bytes(&b, coeff_row(&e->rows, r), (size_t)e->cols * e->rows.elem_size);
+        }
+    }
+
+    if (b.failed) {
+        free(b.data);
+        return NULL;
+    }
+    *len = b.len;
+    return b.data;
+}
+
+typedef struct {
+    const unsigned char* data;
+    size_t len;
+    size_t pos;
+} Cursor;
+
+static const void* take_bytes(Cursor* c, size_t n) {
+    if (n > c->len - c->pos) return NULL;
+    const void* at = c->data + c->pos;
+    c->pos += n;
+    return at;
+}
+
+static int take_int(Cursor* c, int32_t* value) {
+    const void* at = take_bytes(c, sizeof(*value));
+    if (!at) return 0;
+    memcpy(value, at, sizeof(*value));
+    return 1;
+}
+
+static int take_value(Cursor* c, Value* out) {
+    const char* text = (const char*)c->data + c->pos;
+    const char* end = memchr(text, '\0', c->len - c->pos);
+    if (!end) return 0;
+    c->pos += (size_t)(end - text) + 1;
+    return value_parse(text, (size_t)(end - text), out) == 0;
+}
+
+static int decode_row(Echelon* e, Cursor* c, int r) {
+    if (e->q) {
+        for (int j = 0; j < e->cols; j++) {
+            Rational x;
+            if (!take_value(c, &x.num)) return 0;
+            if (!take_value(c, &x.den)) {
+                value_release(x.num);
+                return 0;
+            }
+            rational_release(q_row(e, r)[j]);
+            q_row(e, r)[j] = x;
+            if (value_sign(x.den) <= 0) return 0;
+        }
+        return 1;
+    }
+
+    if (e->modulus == 2 && !e->mont) {
+        const uint64_t* words = take_bytes(c, sizeof(uint64_t) * e->bits.words);
+        if (!words) return 0;
+        memcpy(gf2_row(&e->bits, r), words, sizeof(uint64_t) * e->bits.words);
+        for (int j = e->cols; j < e->bits.words * 64; j++) {
+            if (gf2_get(&e->bits, r, j)) return 0;
+        }
+        return 1;
+    }
+
+    const void* entries = take_bytes(c, (size_t)e->cols * e->rows.elem_size);
+    if (!entries) return 0;
+    memcpy(coeff_row(&e->rows, r), entries, (size_t)e->cols * e->rows.elem_size);
+    for (int j = 0; !e->mont && j < e->cols; j++) {
+        if (coeff_get(&e->rows, r, j) >= e->modulus) return 0;
+    }
+    return 1;
+}
+
+//replaces the rows of e, which must be set up for the same ring and width;
+//on a malformed encoding e is left as it was and -1 is returned
+int echelon_decode(Echelon* e, const unsigned char* data, size_t len) {
+    if (!e || !data) return -1;
+
+    Echelon fresh;
+    if (echelon_init(&fresh, e->cols, e->modulus, e->mont) != 0) return -1;
+
+    Cursor c = {data, len, 0};
+    int32_t cols, rank;
+    int ok = take_int(&c, &cols) && cols == e->cols &&
+             take_int(&c, &rank) && rank >= 0 && rank <= cols;
+
+    for (int r = 0; ok && r < rank; r++) {
+        int32_t pivot;
+        ok = take_int(&c, &pivot) && pivot >= 0 && pivot < cols &&
+             fresh.pivot_row[pivot] < 0 && decode_row(&fresh, &c, r);
+        if (ok) {
+            fresh.pivot_col[r] = pivot;
+            fresh.pivot_row[pivot] = r;
+            fresh.rank++;
+        }
+    }
+
+    if (!ok || c.pos != len) {
+        echelon_free(&fresh);
+        return -1;
+    }
+    echelon_free(e);
+    *e = fresh;
+    return 0;
+}
+
+int echelon_copy(Echelon* dst, const Echelon* src) {
+    size_t len;
+    unsigned char* data = echelon_encode(src, &len);
+    if (!data) return -1;
+
+    int status = echelon_decode(dst, data, len);
+    free(data);
+    return status;
+}
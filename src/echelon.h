@@ -0,0 +1,37 @@
+#ifndef ECHELON_H
+#define ECHELON_H
+
+#include "matrix.h"
+#include "gf2.h"
+#include "mont.h"
+#include "value.h"
+
+//reduced echelon form kept up to date one relation at a time
+typedef struct {
+    int cols;
+    int rank;
+    long long modulus;
+    const MontContext* mont;
+
+    int* pivot_col;
+    int* pivot_row;
+
+    //storage matching the ring; row `cols` is a scratch row
+    CoeffMatrix rows;
+    GF2Matrix bits;
+    GF2XorFn xor_row;
+    Rational* q;
+} Echelon;
+
+int echelon_init(Echelon* e, int cols, long long modulus, const MontContext* mont);
+void echelon_free(Echelon* e);
+
+int echelon_add(Echelon* e, const Value* coeffs);
+char* echelon_normal_form(Echelon* e, const long long* coeffs, const char* const* names);
+
+//a portable image of the stored rows, for caches and for copying between parsers
+unsigned char* echelon_encode(const Echelon* e, size_t* len);
+int echelon_decode(Echelon* e, const unsigned char* data, size_t len);
+int echelon_copy(Echelon* dst, const Echelon* src);
+
+#endif
@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "eval.h"
+#include "fault.h"
+#include "region.h"
+
+#define MAX_BINDINGS 16
+
+typedef struct Env {
+    const char* const* names;
+    const RtValue* values;
+    int count;
+    const struct Env* parent;
+} Env;
+
+static int eval_node(Evaluator* ev, Expr* e, const Env* env, RtValue* out);
+
+static int fail(Evaluator* ev, const char* fmt, ...) {
+    if (ev->error[0] == '\0') {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(ev->error, sizeof(ev->error), fmt, args);
+        va_end(args);
+    }
+    return -1;
+}
+
+void evaluator_init(Evaluator* ev, const Definition* definitions, int definition_count) {
+    if (!ev) return;
+
+    ev->definitions = definitions;
+    ev->definition_count = definition_count;
+    ev->depth = 0;
+    ev->error[0] = '\0';
+    ev->profiler = NULL;
+    ev->function = NULL;
+}
+
+static RtValue number_value(Rational r) {
+    RtValue v;
+    memset(&v, 0, sizeof(v));
+    v.kind = RT_NUMBER;
+    v.number = r;
+    return v;
+}
+
+static RtValue small_value(long long n) {
+    Value v = value_from_long(n);
+    RtValue r = number_value(rational_from_value(v));
+    value_release(v);
+    return r;
+}
+
+//tuple storage for v, taken from the current region while a frame is evaluating
+static void alloc_items(RtValue* v, int count) {
+    size_t bytes = sizeof(RtValue) * (size_t)(count > 0 ? count : 1);
+    RtValue* items = region_alloc(bytes);
+    v->in_region = items != NULL;
+    if (items) memset(items, 0, bytes);
+    else items = calloc((size_t)(count > 0 ? count : 1), sizeof(RtValue));
+    if (!items) {
+        fault_out_of_memory("tuple");
+    }
+    v->items = items;
+    v->item_count = count;
+}
+
+static void free_items(RtValue* v) {
+    if (!v->in_region) free(v->items);
+    v->items = NULL;
+}
+
+//builds the copy in place, so a fault part way leaves c releasable
+static void copy_into(RtValue* c, const RtValue* v) {
+    memset(c, 0, sizeof(*c));
+    c->kind = v->kind;
+
+    if (v->kind == RT_NUMBER) {
+        c->number.num = value_copy(v->number.num);
+        c->number.den = value_copy(v->number.den);
+    } else {
+        alloc_items(c, v->item_count);
+        for (int i = 0; i < v->item_count; i++) copy_into(&c->items[i], &v->items[i]);
+    }
+}
+
+RtValue rt_value_copy(const RtValue* v) {
+    RtValue c;
+    copy_into(&c, v);
+    return c;
+}
+
+void rt_value_release(RtValue* v) {
+    if (!v) return;
+
+    if (v->kind == RT_NUMBER) {
+        rational_release(v->number);
+    } else {
+        for (int i = 0; i < v->item_count; i++) rt_value_release(&v->items[i]);
+        free_items(v);
+    }
+    memset(v, 0, sizeof(*v));
+}
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Text;
+
+static int append(Text* t, const char* s, size_t n) {
+    if (t->len + n + 1 > t->cap) {
+        size_t cap = (t->len + n + 1) * 2;
+        char* grown = realloc(t->data, cap);
+        if (!grown) return -1;
+        t->data = grown;
+        t->cap = cap;
+    }
+    memcpy(t->data + t->len, s, n);
+    t->len += n;
+    t->data[t->len] = '\0';
+    return 0;
+}
+
+static int write_value(Text* t, const RtValue* v) {
+    if (v->kind == RT_NUMBER) {
+        char* number = rational_to_string(v->number);
+        int status = append(t, number, strlen(number));
+        free(number);
+        return status;
+    }
+
+    if (append(t, "(", 1) != 0) return -1;
+    for (int i = 0; i < v->item_count; i++) {
+        if (i > 0 && append(t, ", ", 2) != 0) return -1;
+        if (write_value(t, &v->items[i]) != 0) return -1;
+    }
+    return append(t, ")", 1);
+}
+
+//number text faults when memory runs out, which must not leave the buffer behind
+static int write_guarded(Text* t, const RtValue* v) {
+    Fault fault;
+    if (setjmp(fault.env) != 0) {
+        free(t->data);
+        fault_reraise(&fault);
+    }
+    fault_install(&fault);
+    int status = write_value(t, v);
+    fault_remove(&fault);
+    return status;
+}
+
+char* rt_value_to_string(const RtValue* v) {
+    Text text = {NULL, 0, 0};
+    if (write_guarded(&text, v) != 0) {
+        free(text.data);
+        return NULL;
+    }
+    return text.data;
+}
+
+int rt_value_equal(const RtValue* a, const RtValue* b) {
+    if (a->kind != b->kind) return 0;
+    if (a->kind == RT_NUMBER) return rational_cmp(a->number, b->number) == 0;
+
+    if (a->item_count != b->item_count) return 0;
+    for (int i = 0; i < a->item_count; i++) {
+        if (!rt_value_equal(&a->items[i], &b->items[i])) return 0;
+    }
+    return 1;
+}
+
+static const Definition* find_definition(Evaluator* ev, const char* name) {
+    for (int i = ev->definition_count - 1; i >= 0; i--) {
+        if (ev->definitions[i].name == name) return &ev->definitions[i];
+    }
+    return NULL;
+}
+
+static int floor_mod(Evaluator* ev, const Rational* a, const Rational* b, RtValue* out) {
+    if (!rational_is_integer(*a) || !rational_is_integer(*b)) {
+        return fail(ev, "'%%' needs integer operands");
+    }
+
+    Value r;
+    if (value_divmod(a->num, b->num, NULL, &r) != 0) return fail(ev, "modulo by zero");
+
+    if (value_sign(r) != 0 && value_sign(r) != value_sign(b->num)) {
+        Value adjusted = value_add(r, b->num);
+        value_release(r);
+        r = adjusted;
+    }
+
+    *out = number_value(rational_from_value(r));
+    value_release(r);
+    return 0;
+}
+
+static int arith(Evaluator* ev, ExprKind kind, const RtValue* a, const RtValue* b, RtValue* out) {
+    if (a->kind == RT_NUMBER && b->kind == RT_NUMBER) {
+        switch (kind) {
+            case EXPR_ADD: *out = number_value(rational_add(a->number, b->number)); return 0;
+            case EXPR_SUB: *out = number_value(rational_sub(a->number, b->number)); return 0;
+            case EXPR_MUL: *out = number_value(rational_mul(a->number, b->number)); return 0;
+            case EXPR_DIV: {
+                Rational q;
+                if (rational_div(a->number, b->number, &q) != 0) return fail(ev, "division by zero");
+                *out = number_value(q);
+                return 0;
+            }
+            case EXPR_MOD: return floor_mod(ev, &a->number, &b->number, out);
+            default: return fail(ev, "unsupported operator");
+        }
+    }
+
+    //tuples add componentwise and scale by numbers
+    const RtValue* tuple = a->kind == RT_TUPLE ? a : b;
+    int same_shape = a->kind == b->kind && a->item_count == b->item_count;
+    int scaling = kind == EXPR_MUL && a->kind != b->kind;
+
+    if (!((kind == EXPR_ADD || kind == EXPR_SUB) && same_shape) && !scaling) {
+        return fail(ev, "invalid operands for tuple arithmetic");
+    }
+
+    RtValue result;
+    memset(&result, 0, sizeof(result));
+    result.kind = RT_TUPLE;
+    alloc_items(&result, tuple->item_count);
+
+    for (int i = 0; i < tuple->item_count; i++) {
+        const RtValue* x = a->kind == RT_TUPLE ? &a->items[i] : a;
+        const RtValue* y = b->kind == RT_TUPLE ? &b->items[i] : b;
+        if (arith(ev, kind, x, y, &result.items[i]) != 0) {
+            result.item_count = i;
+            rt_value_release(&result);
+            return -1;
+        }
+    }
+
+    *out = result;
+    return 0;
+}
+
+static int compare(Evaluator* ev, ExprKind kind, const RtValue* a, const RtValue* b, RtValue* out) {
+    int truth;
+
+    if (kind == EXPR_EQ || kind == EXPR_NE) {
+        truth = rt_value_equal(a, b);
+        if (kind == EXPR_NE) truth = !truth;
+    } else {
+        if (a->kind != RT_NUMBER || b->kind != RT_NUMBER) return fail(ev, "ordering needs numbers");
+
+        int cmp = rational_cmp(a->number, b->number);
+        switch (kind) {
+            case EXPR_LT: truth = cmp < 0; break;
+            case EXPR_GT: truth = cmp > 0; break;
+            case EXPR_LE: truth = cmp <= 0; break;
+            default: truth = cmp >= 0; break;
+        }
+    }
+
+    *out = small_value(truth);
+    return 0;
+}
+
+static int lookup(Evaluator* ev, const char* name, const Env* env, RtValue* out) {
+    for (const Env* frame = env; frame; frame = frame->parent) {
+        for (int i = frame->count - 1; i >= 0; i--) {
+            if (frame->names[i] == name) {
+                *out = rt_value_copy(&frame->values[i]);
+                return 0;
+            }
+        }
+    }
+
+    const Definition* def = find_definition(ev, name);
+    if (!def) return fail(ev, "unknown name '%s'", name);
+    if (def->param_count > 0) return fail(ev, "'%s' needs %d argument(s)", name, def->param_count);
+    if (!def->evaluated) return fail(ev, "'%s' has no value", name);
+
+    *out = rt_value_copy(&def->value);
+    return 0;
+}
+
+typedef struct {
+    const char* names[MAX_BINDINGS];
+    RtValue values[MAX_BINDINGS];
+    int count;
+} Bindings;
+
+static void release_bindings(Bindings* b) {
+    for (int i = 0; i < b->count; i++) rt_value_release(&b->values[i]);
+    b->count = 0;
+}
+
+//1 on match, 0 on mismatch, -1 on error
+static int match_pattern(Evaluator* ev, Expr* pattern, const RtValue* value,
+                         const Env* env, Bindings* bindings) {
+    if (pattern->kind == EXPR_VARIABLE) {
+        if (strcmp(pattern->name, "_") == 0) return 1;
+        if (bindings->count >= MAX_BINDINGS) return fail(ev, "too many pattern variables");
+
+        bindings->names[bindings->count] = pattern->name;
+        bindings->values[bindings->count] = rt_value_copy(value);
+        bindings->count++;
+        return 1;
+    }
+
+    if (pattern->kind == EXPR_TUPLE) {
+        if (value->kind != RT_TUPLE || value->item_count != pattern->item_count) return 0;
+        for (int i = 0; i < pattern->item_count; i++) {
+            int m = match_pattern(ev, pattern->items[i], &value->items[i], env, bindings);
+            if (m != 1) return m;
+        }
+        return 1;
+    }
+
+    RtValue expected;
+    if (eval_node(ev, pattern, env, &expected) != 0) return -1;
+    int m = rt_value_equal(&expected, value);
+    rt_value_release(&expected);
+    return m;
+}
+
+static int eval_case(Evaluator* ev, Expr* e, const Env* env, RtValue* out) {
+    RtValue subject;
+    if (eval_node(ev, e->left, env, &subject) != 0) return -1;
+
+    int status = -1;
+    int matched = 0;
+    for (int i = 0; i < e->item_count && !matched; i++) {
+        Expr* arm = e->items[i];
+        Bindings bindings;
+        bindings.count = 0;
+
+        int m = match_pattern(ev, arm->left, &subject, env, &bindings);
+        if (m == 1) {
+            Env frame = {bindings.names, bindings.values, bindings.count, env};
+            profile_enter_arm(ev->profiler, ev->function, i + 1);
+            status = eval_node(ev, arm->right, &frame, out);
+            profile_leave(ev->profiler);
+            matched = 1;
+        } else if (m < 0) {
+            matched = 1;
+        }
+        release_bindings(&bindings);
+    }
+
+    if (!matched) status = fail(ev, "no case arm matched");
+    rt_value_release(&subject);
+    return status;
+}
+
+static int eval_items(Evaluator* ev, Expr* e, const Env* env, RtValue* items) {
+    for (int i = 0; i < e->item_count; i++) {
+        if (eval_node(ev, e->items[i], env, &items[i]) != 0) {
+            for (int j = 0; j < i; j++) rt_value_release(&items[j]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int eval_call_expr(Evaluator* ev, Expr* e, const Env* env, RtValue* out) {
+    const Definition* def = find_definition(ev, e->name);
+    if (!def) return fail(ev, "unknown function '%s'", e->name);
+
+    RtValue args[MAX_PARAMS];
+    if (e->item_count > MAX_PARAMS) return fail(ev, "too many arguments to '%s'", e->name);
+    if (eval_items(ev, e, env, args) != 0) return -1;
+
+    int status = eval_call(ev, def, args, e->item_count, out);
+    for (int i = 0; i < e->item_count; i++) rt_value_release(&args[i]);
+    return status;
+}
+
+static int eval_node(Evaluator* ev, Expr* e, const Env* env, RtValue* out) {
+    RtValue a, b;
+    int status;
+
+    switch (e->kind) {
+        case EXPR_NUMBER:
+            *out = number_value(rational_from_value(e->value));
+            return 0;
+        case EXPR_VARIABLE:
+            return lookup(ev, e->name, env, out);
+        case EXPR_NEG:
+            if (eval_node(ev, e->left, env, &a) != 0) return -1;
+            b = small_value(-1);
+            status = arith(ev, EXPR_MUL, &b, &a, out);
+            rt_value_release(&a);
+            rt_value_release(&b);
+            return status;
+        case EXPR_ADD: case EXPR_SUB: case EXPR_MUL: case EXPR_DIV: case EXPR_MOD:
+        case EXPR_EQ: case EXPR_NE: case EXPR_LT: case EXPR_GT: case EXPR_LE: case EXPR_GE:
+            if (eval_node(ev, e->left, env, &a) != 0) return -1;
+            if (eval_node(ev, e->right, env, &b) != 0) {
+                rt_value_release(&a);
+                return -1;
+            }
+            if (e->kind >= EXPR_EQ) status = compare(ev, e->kind, &a, &b, out);
+            else status = arith(ev, e->kind, &a, &b, out);
+            rt_value_release(&a);
+            rt_value_release(&b);
+            return status;
+        case EXPR_TUPLE: {
+            RtValue tuple;
+            memset(&tuple, 0, sizeof(tuple));
+            tuple.kind = RT_TUPLE;
+            alloc_items(&tuple, e->item_count);
+            if (eval_items(ev, e, env, tuple.items) != 0) {
+                free_items(&tuple);
+                return -1;
+            }
+            *out = tuple;
+            return 0;
+        }
+        case EXPR_CALL:
+            return eval_call_expr(ev, e, env, out);
+        case EXPR_CASE:
+            return eval_case(ev, e, env, out);
+        default:
+            return fail(ev, "expression cannot be evaluated");
+    }
+}
+
+//heap memory is not unwound with the regions, so a fault part way through the copy
+//releases what was copied before passing the fault on
+static void copy_to_heap(const RtValue* v, RtValue* out) {
+    Fault fault;
+    if (setjmp(fault.env) != 0) {
+        rt_value_release(out);
+        fault_reraise(&fault);
+    }
+    fault_install(&fault);
+    copy_into(out, v);
+    fault_remove(&fault);
+}
+
+//temporaries of a frame die with its region; the result is copied out into the
+//caller's region, or to the heap once it leaves the outermost one
+static int promote(Region* region, int status, RtValue* result, RtValue* out) {
+    region_leave(region);
+    if (status == 0) {
+        if (region->outer) copy_into(out, result);
+        else copy_to_heap(result, out);
+        rt_value_release(result);
+    }
+    region_release(region);
+    return status;
+}
+
+int eval_expr(Evaluator* ev, Expr* e, RtValue* out) {
+    if (!ev || !e || !out) return -1;
+
+    Region region;
+    RtValue result;
+    region_enter(&region);
+    int status = eval_node(ev, e, NULL, &result);
+    return promote(&region, status, &result, out);
+}
+
+int eval_call(Evaluator* ev, const Definition* def, const RtValue* args, int arg_count, RtValue* out) {
+    if (!ev || !def || !out) return -1;
+
+    if (arg_count != def->param_count) {
+        return fail(ev, "'%s' expects %d argument(s), got %d", def->name, def->param_count, arg_count);
+    }
+    if (ev->depth >= MAX_EVAL_DEPTH) {
+        return fail(ev, "recursion deeper than %d calls in '%s'", MAX_EVAL_DEPTH, def->name);
+    }
+
+    Env frame = {def->params, args, arg_count, NULL};
+
+    const char* caller = ev->function;
+    ev->function = def->name;
+    profile_enter(ev->profiler, def->name);
+
+    Region region;
+    RtValue result;
+    region_enter(&region);
+    ev->depth++;
+    int status = eval_node(ev, def->body, &frame, &result);
+    ev->depth--;
+    status = promote(&region, status, &result, out);
+
+    profile_leave(ev->profiler);
+    ev->function = caller;
+    return status;
+}
@@ -0,0 +1,57 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "expr.h"
+#include "value.h"
+#include "profile.h"
+
+#define MAX_DEFINITIONS 256
+#define MAX_PARAMS 8
+#define MAX_EVAL_DEPTH 2000
+
+typedef enum {
+    RT_NUMBER, RT_TUPLE
+} RtKind;
+
+typedef struct RtValue {
+    RtKind kind;
+    Rational number;
+    struct RtValue* items;
+    int item_count;
+
+    //items belong to an evaluation region (see region.h) rather than the heap
+    int in_region;
+} RtValue;
+
+typedef struct {
+    const char* name;
+    const char* params[MAX_PARAMS];
+    int param_count;
+    Expr* body;
+
+    int evaluated;
+    RtValue value;
+} Definition;
+
+typedef struct {
+    const Definition* definitions;
+    int definition_count;
+    int depth;
+    char error[128];
+
+    //optional: attributes time to definitions and case arms
+    Profiler* profiler;
+    const char* function;
+} Evaluator;
+
+void evaluator_init(Evaluator* ev, const Definition* definitions, int definition_count);
+
+int eval_expr(Evaluator* ev, Expr* e, RtValue* out);
+int eval_call(Evaluator* ev, const Definition* def, const RtValue* args, int arg_count, RtValue* out);
+
+RtValue rt_value_copy(const RtValue* v);
+int rt_value_equal(const RtValue* a, const RtValue* b);
+void rt_value_release(RtValue* v);
+char* rt_value_to_string(const RtValue* v);
+
+#endif
@@ -0,0 +1,799 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "expr.h"
+#include "fault.h"
+#include "modular.h"
+
+#define EXPR_ARENA_CHUNK 65536
+#define EXPR_TABLE_INITIAL 256
+
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+} ArenaChunk;
+
+struct ExprPool {
+    ArenaChunk* chunks;
+
+    Expr** nodes;
+    unsigned node_capacity;
+    unsigned node_count;
+
+    const char** strings;
+    unsigned string_capacity;
+    unsigned string_count;
+
+    Value* values;
+    unsigned value_capacity;
+    unsigned value_count;
+
+    ExprLookup lookup;
+    void* lookup_ctx;
+    long long modulus;
+    unsigned epoch;
+};
+
+static void* arena_alloc(ExprPool* pool, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+
+    ArenaChunk* chunk = pool->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t chunk_size = size > EXPR_ARENA_CHUNK ? size : EXPR_ARENA_CHUNK;
+        chunk = malloc(sizeof(ArenaChunk) + chunk_size);
+        if (!chunk) {
+            fault_out_of_memory("expression pool");
+        }
+        chunk->next = pool->chunks;
+        chunk->used = 0;
+        chunk->size = chunk_size;
+        pool->chunks = chunk;
+    }
+
+    void* result = chunk->data + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+static unsigned hash_mix(unsigned h, uintptr_t v) {
+    h ^= (unsigned)(v ^ (v >> 32));
+    h *= 0x9E3779B1u;
+    return h ^ (h >> 15);
+}
+
+static unsigned hash_string(const char* s) {
+    unsigned h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+ExprPool* expr_pool_create(void) {
+    ExprPool* pool = calloc(1, sizeof(ExprPool));
+    if (!pool) return NULL;
+
+    pool->node_capacity = EXPR_TABLE_INITIAL;
+    pool->nodes = calloc(pool->node_capacity, sizeof(Expr*));
+    pool->string_capacity = EXPR_TABLE_INITIAL;
+    pool->strings = calloc(pool->string_capacity, sizeof(char*));
+
+    if (!pool->nodes || !pool->strings) {
+        expr_pool_destroy(pool);
+        return NULL;
+    }
+
+    pool->epoch = 1;
+    return pool;
+}
+
+void expr_pool_destroy(ExprPool* pool) {
+    if (!pool) return;
+
+    ArenaChunk* chunk = pool->chunks;
+    while (chunk) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    for (unsigned i = 0; i < pool->value_count; i++) {
+        value_release(pool->values[i]);
+    }
+
+    free(pool->nodes);
+    free(pool->strings);
+    free(pool->values);
+    free(pool);
+}
+
+//hands a bignum to the pool so it lives as long as the nodes and forms holding it
+static Value pool_value(ExprPool* pool, Value v) {
+    if (value_is_fixnum(v)) return v;
+
+    if (pool->value_count == pool->value_capacity) {
+        unsigned capacity = pool->value_capacity ? pool->value_capacity * 2 : 64;
+        Value* values = realloc(pool->values, sizeof(Value) * capacity);
+        if (!values) {
+            value_release(v);
+            fault_out_of_memory("expression pool");
+        }
+        pool->values = values;
+        pool->value_capacity = capacity;
+    }
+
+    pool->values[pool->value_count++] = v;
+    return v;
+}
+
+static void grow_strings(ExprPool* pool) {
+    unsigned capacity = pool->string_capacity * 2;
+    const char** strings = calloc(capacity, sizeof(char*));
+    if (!strings) {
+        fault_out_of_memory("string table");
+    }
+
+    for (unsigned i = 0; i < pool->string_capacity; i++) {
+        const char* s = pool->strings[i];
+        if (!s) continue;
+        unsigned slot = hash_string(s) & (capacity - 1);
+        while (strings[slot]) slot = (slot + 1) & (capacity - 1);
+        strings[slot] = s;
+    }
+
+    free(pool->strings);
+    pool->strings = strings;
+    pool->string_capacity = capacity;
+}
+
+const char* expr_intern(ExprPool* pool, const char* text) {
+    if (!pool || !text) return NULL;
+
+    if ((pool->string_count + 1) * 10 > pool->string_capacity * 7) {
+        grow_strings(pool);
+    }
+
+    unsigned slot = hash_string(text) & (pool->string_capacity - 1);
+    while (pool->strings[slot]) {
+        if (strcmp(pool->strings[slot], text) == 0) return pool->strings[slot];
+        slot = (slot + 1) & (pool->string_capacity - 1);
+    }
+
+    size_t len = strlen(text);
+    char* copy = arena_alloc(pool, len + 1);
+    memcpy(copy, text, len + 1);
+    pool->strings[slot] = copy;
+    pool->string_count++;
+    return copy;
+}
+
+static unsigned hash_node(const Expr* e) {
+    unsigned h = hash_mix(0x811C9DC5u, (uintptr_t)e->kind);
+    h = hash_mix(h, (uintptr_t)e->name);
+    h = hash_mix(h, (uintptr_t)e->left);
+    h = hash_mix(h, (uintptr_t)e->right);
+    h = hash_mix(h, (uintptr_t)e->item_count);
+    for (int i = 0; i < e->item_count; i++) {
+        h = hash_mix(h, (uintptr_t)e->items[i]);
+    }
+    return h;
+}
+
+static int same_node(const Expr* a, const Expr* b) {
+    if (a->kind != b->kind || a->name != b->name ||
+        a->left != b->left || a->right != b->right ||
+        a->item_count != b->item_count) {
+        return 0;
+    }
+    for (int i = 0; i < a->item_count; i++) {
+        if (a->items[i] != b->items[i]) return 0;
+    }
+    return 1;
+}
+
+static void grow_nodes(ExprPool* pool) {
+    unsigned capacity = pool->node_capacity * 2;
+    Expr** nodes = calloc(capacity, sizeof(Expr*));
+    if (!nodes) {
+        fault_out_of_memory("expression table");
+    }
+
+    for (unsigned i = 0; i < pool->node_capacity; i++) {
+        Expr* e = pool->nodes[i];
+        if (!e) continue;
+        unsigned slot = e->hash & (capacity - 1);
+        while (nodes[slot]) slot = (slot + 1) & (capacity - 1);
+        nodes[slot] = e;
+    }
+
+    free(pool->nodes);
+    pool->nodes = nodes;
+    pool->node_capacity = capacity;
+}
+
+//returns the shared node structurally equal to key, creating it on first use
+static Expr* intern_node(ExprPool* pool, Expr* key) {
+    if ((pool->node_count + 1) * 10 > pool->node_capacity * 7) {
+        grow_nodes(pool);
+    }
+
+    key->hash = hash_node(key);
+    unsigned slot = key->hash & (pool->node_capacity - 1);
+    while (pool->nodes[slot]) {
+        Expr* existing = pool->nodes[slot];
+        if (existing->hash == key->hash && same_node(existing, key)) {
+            return existing;
+        }
+        slot = (slot + 1) & (pool->node_capacity - 1);
+    }
+
+    Expr* e = arena_alloc(pool, sizeof(Expr));
+    *e = *key;
+    e->id = pool->node_count;
+    if (key->item_count > 0) {
+        e->items = arena_alloc(pool, sizeof(Expr*) * key->item_count);
+        memcpy(e->items, key->items, sizeof(Expr*) * key->item_count);
+    }
+
+    pool->nodes[slot] = e;
+    pool->node_count++;
+    return e;
+}
+
+Expr* expr_number(ExprPool* pool, const char* digits) {
+    if (!pool || !digits) return NULL;
+
+    while (digits[0] == '0' && digits[1] != '\0') digits++;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = EXPR_NUMBER;
+    key.name = expr_intern(pool, digits);
+
+    key.number = 0;
+    for (const char* d = digits; *d; d++) {
+        if (key.number > (LLONG_MAX - (*d - '0')) / 10) {
+            key.number = LLONG_MAX;
+            break;
+        }
+        key.number = key.number * 10 + (*d - '0');
+    }
+
+    Expr* e = intern_node(pool, &key);
+    if (!e->value) e->value = pool_value(pool, value_from_decimal(digits, strlen(digits)));
+    return e;
+}
+
+Expr* expr_variable(ExprPool* pool, const char* name) {
+    if (!pool || !name) return NULL;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = EXPR_VARIABLE;
+    key.name = expr_intern(pool, name);
+    return intern_node(pool, &key);
+}
+
+Expr* expr_unary(ExprPool* pool, ExprKind kind, Expr* operand) {
+    if (!pool || !operand) return NULL;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.left = operand;
+    return intern_node(pool, &key);
+}
+
+Expr* expr_binary(ExprPool* pool, ExprKind kind, Expr* left, Expr* right) {
+    if (!pool || !left || !right) return NULL;
+
+    //commutative operands are ordered so a+b and b+a share one node
+    if ((kind == EXPR_ADD || kind == EXPR_MUL || kind == EXPR_EQ || kind == EXPR_NE) &&
+        left->id > right->id) {
+        Expr* tmp = left;
+        left = right;
+        right = tmp;
+    }
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.left = left;
+    key.right = right;
+    return intern_node(pool, &key);
+}
+
+Expr* expr_call(ExprPool* pool, const char* name, Expr** args, int arg_count) {
+    if (!pool || !name || arg_count < 0) return NULL;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = EXPR_CALL;
+    key.name = expr_intern(pool, name);
+    key.items = args;
+    key.item_count = arg_count;
+    return intern_node(pool, &key);
+}
+
+Expr* expr_tuple(ExprPool* pool, Expr** items, int item_count) {
+    if (!pool || item_count < 0) return NULL;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = EXPR_TUPLE;
+    key.items = items;
+    key.item_count = item_count;
+    return intern_node(pool, &key);
+}
+
+Expr* expr_case(ExprPool* pool, Expr* subject, Expr** arms, int arm_count) {
+    if (!pool || !subject || arm_count < 0) return NULL;
+
+    Expr key;
+    memset(&key, 0, sizeof(key));
+    key.kind = EXPR_CASE;
+    key.left = subject;
+    key.items = arms;
+    key.item_count = arm_count;
+    return intern_node(pool, &key);
+}
+
+//the same tree interned into another pool, as when a definition is imported
+Expr* expr_copy(ExprPool* pool, const Expr* e) {
+    if (!pool || !e || e->item_count > EXPR_MAX_ITEMS) return NULL;
+
+    Expr* left = e->left ? expr_copy(pool, e->left) : NULL;
+    Expr* right = e->right ? expr_copy(pool, e->right) : NULL;
+    Expr* items[EXPR_MAX_ITEMS];
+    for (int i = 0; i < e->item_count; i++) {
+        items[i] = expr_copy(pool, e->items[i]);
+        if (!items[i]) return NULL;
+    }
+
+    switch (e->kind) {
+        case EXPR_NUMBER:
+            return expr_number(pool, e->name);
+        case EXPR_VARIABLE:
+            return expr_variable(pool, e->name);
+        case EXPR_NEG:
+            return expr_unary(pool, e->kind, left);
+        case EXPR_CALL:
+            return expr_call(pool, e->name, items, e->item_count);
+        case EXPR_TUPLE:
+            return expr_tuple(pool, items, e->item_count);
+        case EXPR_CASE:
+            return expr_case(pool, left, items, e->item_count);
+        default:
+            return expr_binary(pool, e->kind, left, right);
+    }
+}
+
+int expr_pool_node_count(const ExprPool* pool) {
+    return pool ? (int)pool->node_count : 0;
+}
+
+typedef struct {
+    ExprPool* pool;
+    const Token* tokens;
+    int pos;
+    int end;
+} ExprCursor;
+
+
+static Expr* parse_comparison(ExprCursor* c);
+
+static TokenType peek(ExprCursor* c) {
+    return c->pos < c->end ? c->tokens[c->pos].type : TOKEN_EOF;
+}
+
+static int is_callable_keyword(TokenType type) {
+    return type == TOKEN_KERNEL || type == TOKEN_IMAGE || type == TOKEN_COMPOSE ||
+           type == TOKEN_APPLY || type == TOKEN_MAP || type == TOKEN_FOLD ||
+           type == TOKEN_UNFOLD || type == TOKEN_FILTER;
+}
+
+static int parse_items(ExprCursor* c, Expr** items, int* count) {
+    *count = 0;
+    if (peek(c) == TOKEN_RPAREN) {
+        c->pos++;
+        return 0;
+    }
+
+    while (1) {
+        if (*count >= EXPR_MAX_ITEMS) return -1;
+        Expr* item = parse_comparison(c);
+        if (!item) return -1;
+        items[(*count)++] = item;
+
+        if (peek(c) == TOKEN_COMMA) {
+            c->pos++;
+            continue;
+        }
+        if (peek(c) == TOKEN_RPAREN) {
+            c->pos++;
+            return 0;
+        }
+        return -1;
+    }
+}
+
+//case <subject> of { <pattern> -> <expr>; ... }
+static Expr* parse_case(ExprCursor* c) {
+    Expr* subject = parse_comparison(c);
+    if (!subject || peek(c) != TOKEN_OF) return NULL;
+    c->pos++;
+    if (peek(c) != TOKEN_LBRACE) return NULL;
+    c->pos++;
+
+    Expr* arms[EXPR_MAX_ITEMS];
+    int arm_count = 0;
+
+    while (peek(c) != TOKEN_RBRACE) {
+        if (arm_count >= EXPR_MAX_ITEMS) return NULL;
+
+        Expr* pattern = parse_comparison(c);
+        if (!pattern || peek(c) != TOKEN_ARROW) return NULL;
+        c->pos++;
+
+        Expr* body = parse_comparison(c);
+        if (!body) return NULL;
+        arms[arm_count++] = expr_binary(c->pool, EXPR_ARM, pattern, body);
+
+        if (peek(c) == TOKEN_SEMICOLON) c->pos++;
+    }
+    c->pos++;
+
+    return expr_case(c->pool, subject, arms, arm_count);
+}
+
+static Expr* parse_primary(ExprCursor* c) {
+    TokenType type = peek(c);
+    const Token* tok = &c->tokens[c->pos];
+
+    if (type == TOKEN_NUMBER) {
+        c->pos++;
+        return expr_number(c->pool, tok->value);
+    }
+
+    if (type == TOKEN_IDENTIFIER || is_callable_keyword(type)) {
+        c->pos++;
+        if (peek(c) == TOKEN_LPAREN) {
+            c->pos++;
+            Expr* args[EXPR_MAX_ITEMS];
+            int arg_count;
+            if (parse_items(c, args, &arg_count) != 0) return NULL;
+            return expr_call(c->pool, tok->value, args, arg_count);
+        }
+        if (type != TOKEN_IDENTIFIER) return NULL;
+        return expr_variable(c->pool, tok->value);
+    }
+
+    if (type == TOKEN_CASE) {
+        c->pos++;
+        return parse_case(c);
+    }
+
+    if (type == TOKEN_LPAREN) {
+        c->pos++;
+        Expr* items[EXPR_MAX_ITEMS];
+        int item_count;
+        if (parse_items(c, items, &item_count) != 0) return NULL;
+        if (item_count == 1) return items[0];
+        return expr_tuple(c->pool, items, item_count);
+    }
+
+    return NULL;
+}
+
+static Expr* parse_unary(ExprCursor* c) {
+    if (peek(c) == TOKEN_MINUS) {
+        c->pos++;
+        Expr* operand = parse_unary(c);
+        return operand ? expr_unary(c->pool, EXPR_NEG, operand) : NULL;
+    }
+    return parse_primary(c);
+}
+
+static Expr* parse_term(ExprCursor* c) {
+    Expr* left = parse_unary(c);
+
+    while (left) {
+        ExprKind kind;
+        switch (peek(c)) {
+            case TOKEN_STAR: kind = EXPR_MUL; break;
+            case TOKEN_SLASH: kind = EXPR_DIV; break;
+            case TOKEN_MOD: kind = EXPR_MOD; break;
+            default: return left;
+        }
+        c->pos++;
+        left = expr_binary(c->pool, kind, left, parse_unary(c));
+    }
+    return left;
+}
+
+static Expr* parse_additive(ExprCursor* c) {
+    Expr* left = parse_term(c);
+
+    while (left) {
+        ExprKind kind;
+        switch (peek(c)) {
+            case TOKEN_PLUS: kind = EXPR_ADD; break;
+            case TOKEN_MINUS: kind = EXPR_SUB; break;
+            default: return left;
+        }
+        c->pos++;
+        left = expr_binary(c->pool, kind, left, parse_term(c));
+    }
+    return left;
+}
+
+static Expr* parse_comparison(ExprCursor* c) {
+    Expr* left = parse_additive(c);
+    if (!left) return NULL;
+
+    ExprKind kind;
+    switch (peek(c)) {
+        case TOKEN_EQ: kind = EXPR_EQ; break;
+        case TOKEN_NE: kind = EXPR_NE; break;
+        case TOKEN_LT: kind = EXPR_LT; break;
+        case TOKEN_GT: kind = EXPR_GT; break;
+        case TOKEN_LE: kind = EXPR_LE; break;
+        case TOKEN_GE: kind = EXPR_GE; break;
+        default: return left;
+    }
+    c->pos++;
+    return expr_binary(c->pool, kind, left, parse_additive(c));
+}
+
+Expr* expr_parse(ExprPool* pool, const Token* tokens, int* pos, int end) {
+    if (!pool || !tokens || !pos || *pos >= end) return NULL;
+
+    ExprCursor c = {pool, tokens, *pos, end};
+    Expr* e = parse_comparison(&c);
+    if (e) *pos = c.pos;
+    return e;
+}
+
+void expr_pool_bind(ExprPool* pool, ExprLookup lookup, void* ctx, long long modulus) {
+    if (!pool) return;
+
+    pool->lookup = lookup;
+    pool->lookup_ctx = ctx;
+    pool->modulus = modulus > 0 ? modulus : 0;
+    pool->epoch++;
+}
+
+static long long reduce(long long v, long long m) {
+    v %= m;
+    return v < 0 ? v + m : v;
+}
+
+static int checked_add(long long a, long long b, long long* out) {
+    if ((b > 0 && a > LLONG_MAX - b) || (b < 0 && a < LLONG_MIN - b)) return -1;
+    *out = a + b;
+    return 0;
+}
+
+static int checked_mul(long long a, long long b, long long* out) {
+    if (a == 0 || b == 0) {
+        *out = 0;
+        return 0;
+    }
+    if ((a == -1 && b == LLONG_MIN) || (b == -1 && a == LLONG_MIN)) return -1;
+    long long product = a * b;
+    if (product / b != a) return -1;
+    *out = product;
+    return 0;
+}
+
+static int number_fits(const Expr* e) {
+    return e->number != LLONG_MAX || strcmp(e->name, "9223372036854775807") == 0;
+}
+
+static int eval_node(ExprPool* pool, Expr* e, long long* value);
+
+static int eval_binary(ExprPool* pool, Expr* e, long long* value) {
+    long long a, b;
+    if (eval_node(pool, e->left, &a) != 0 || eval_node(pool, e->right, &b) != 0) return -1;
+
+    long long m = pool->modulus;
+    switch (e->kind) {
+        case EXPR_ADD:
+            if (m) { *value = mod_add(a, b, m); return 0; }
+            return checked_add(a, b, value);
+        case EXPR_SUB:
+            if (m) { *value = mod_sub(a, b, m); return 0; }
+            if (b == LLONG_MIN) return -1;
+            return checked_add(a, -b, value);
+        case EXPR_MUL:
+            if (m) { *value = mod_mul(a, b, m); return 0; }
+            return checked_mul(a, b, value);
+        case EXPR_DIV:
+            if (m) {
+                long long inverse = mod_inverse(b, m);
+                if (!inverse) return -1;
+                *value = mod_mul(a, inverse, m);
+                return 0;
+            }
+            if (b == 0 || a % b != 0) return -1;
+            *value = a / b;
+            return 0;
+        case EXPR_MOD:
+            if (b == 0) return -1;
+            *value = reduce(a, b < 0 ? -b : b);
+            return 0;
+        case EXPR_EQ: *value = (a == b); return 0;
+        case EXPR_NE: *value = (a != b); return 0;
+        case EXPR_LT: *value = (a < b); return 0;
+        case EXPR_GT: *value = (a > b); return 0;
+        case EXPR_LE: *value = (a <= b); return 0;
+        case EXPR_GE: *value = (a >= b); return 0;
+        default: return -1;
+    }
+}
+
+static int eval_node(ExprPool* pool, Expr* e, long long* value) {
+    if (e->eval_epoch == pool->epoch) {
+        *value = e->eval_value;
+        return e->eval_status;
+    }
+
+    int status = -1;
+    long long result = 0;
+
+    switch (e->kind) {
+        case EXPR_NUMBER:
+            if (pool->modulus) {
+                result = value_mod_long(e->value, pool->modulus);
+                status = 0;
+            } else if (number_fits(e)) {
+                result = e->number;
+                status = 0;
+            }
+            break;
+        case EXPR_VARIABLE:
+            if (pool->lookup && pool->lookup(pool->lookup_ctx, e->name, &result) == 0) {
+                if (pool->modulus) result = reduce(result, pool->modulus);
+                status = 0;
+            }
+            break;
+        case EXPR_NEG:
+            if (eval_node(pool, e->left, &result) == 0 && result != LLONG_MIN) {
+                result = pool->modulus ? mod_sub(0, result, pool->modulus) : -result;
+                status = 0;
+            }
+            break;
+        case EXPR_CALL:
+        case EXPR_TUPLE:
+            break;
+        default:
+            status = eval_binary(pool, e, &result);
+            break;
+    }
+
+    e->eval_epoch = pool->epoch;
+    e->eval_status = status;
+    e->eval_value = result;
+    *value = result;
+    return status;
+}
+
+int expr_eval(ExprPool* pool, Expr* e, long long* value) {
+    if (!pool || !e || !value) return -1;
+    return eval_node(pool, e, value);
+}
+
+static LinearForm* new_form(ExprPool* pool, int term_count) {
+    LinearForm* form = arena_alloc(pool, sizeof(LinearForm));
+    form->terms = term_count > 0 ? arena_alloc(pool, sizeof(LinearTerm) * term_count) : NULL;
+    form->term_count = term_count;
+    form->constant = value_from_fixnum(0);
+    return form;
+}
+
+static const LinearForm* scale_form(ExprPool* pool, const LinearForm* f, Value k) {
+    if (value_sign(k) == 0) return new_form(pool, 0);
+
+    LinearForm* result = new_form(pool, f->term_count);
+    result->constant = pool_value(pool, value_mul(f->constant, k));
+    for (int i = 0; i < f->term_count; i++) {
+        result->terms[i].var = f->terms[i].var;
+        result->terms[i].coeff = pool_value(pool, value_mul(f->terms[i].coeff, k));
+    }
+    return result;
+}
+
+//merges two sorted forms as a + b or a - b, dropping cancelled terms
+static const LinearForm* combine_forms(ExprPool* pool, const LinearForm* a,
+                                       const LinearForm* b, int subtract) {
+    LinearForm* result = new_form(pool, a->term_count + b->term_count);
+    result->constant = pool_value(pool, subtract ? value_sub(a->constant, b->constant)
+                                                 : value_add(a->constant, b->constant));
+
+    int i = 0, j = 0, n = 0;
+    while (i < a->term_count || j < b->term_count) {
+        int cmp;
+        if (i >= a->term_count) cmp = 1;
+        else if (j >= b->term_count) cmp = -1;
+        else cmp = strcmp(a->terms[i].var, b->terms[j].var);
+
+        LinearTerm term;
+        if (cmp < 0) {
+            term = a->terms[i++];
+        } else if (cmp > 0) {
+            term.var = b->terms[j].var;
+            term.coeff = subtract ? pool_value(pool, value_neg(b->terms[j].coeff)) : b->terms[j].coeff;
+            j++;
+        } else {
+            term.var = a->terms[i].var;
+            term.coeff = pool_value(pool, subtract ? value_sub(a->terms[i].coeff, b->terms[j].coeff)
+                                                   : value_add(a->terms[i].coeff, b->terms[j].coeff));
+            i++;
+            j++;
+        }
+
+        if (value_sign(term.coeff) != 0) result->terms[n++] = term;
+    }
+
+    result->term_count = n;
+    return result;
+}
+
+static const LinearForm* normalize_node(ExprPool* pool, Expr* e) {
+    if (e->normal_done) return e->normal;
+
+    const LinearForm* result = NULL;
+    const LinearForm* a;
+    const LinearForm* b;
+
+    switch (e->kind) {
+        case EXPR_NUMBER: {
+            LinearForm* f = new_form(pool, 0);
+            f->constant = e->value;
+            result = f;
+            break;
+        }
+        case EXPR_VARIABLE: {
+            LinearForm* f = new_form(pool, 1);
+            f->terms[0].var = e->name;
+            f->terms[0].coeff = value_from_fixnum(1);
+            result = f;
+            break;
+        }
+        case EXPR_NEG:
+            a = normalize_node(pool, e->left);
+            if (a) result = scale_form(pool, a, value_from_fixnum(-1));
+            break;
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_EQ:
+            a = normalize_node(pool, e->left);
+            b = normalize_node(pool, e->right);
+            if (a && b) result = combine_forms(pool, a, b, e->kind != EXPR_ADD);
+            break;
+        case EXPR_MUL:
+            a = normalize_node(pool, e->left);
+            b = normalize_node(pool, e->right);
+            if (a && b) {
+                if (a->term_count == 0) result = scale_form(pool, b, a->constant);
+                else if (b->term_count == 0) result = scale_form(pool, a, b->constant);
+            }
+            break;
+        default:
+            break;
+    }
+
+    e->normal_done = 1;
+    e->normal = result;
+    return result;
+}
+
+const LinearForm* expr_normalize(ExprPool* pool, Expr* e) {
+    if (!pool || !e) return NULL;
+    return normalize_node(pool, e);
+}
@@ -0,0 +1,78 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "lexer.h"
+#include "value.h"
+
+typedef enum {
+    EXPR_NUMBER, EXPR_VARIABLE, EXPR_NEG,
+    EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV, EXPR_MOD,
+    EXPR_EQ, EXPR_NE, EXPR_LT, EXPR_GT, EXPR_LE, EXPR_GE,
+    EXPR_CALL, EXPR_TUPLE, EXPR_CASE, EXPR_ARM
+} ExprKind;
+
+#define EXPR_MAX_ITEMS 64
+
+typedef struct {
+    const char* var;
+    Value coeff;
+} LinearTerm;
+
+//sum of coeff*var plus a constant, terms sorted by variable
+typedef struct {
+    LinearTerm* terms;
+    int term_count;
+    Value constant;
+} LinearForm;
+
+typedef struct Expr {
+    ExprKind kind;
+    unsigned id;
+    unsigned hash;
+
+    const char* name;
+    long long number;
+    //a number's literal, owned by the pool
+    Value value;
+
+    struct Expr* left;
+    struct Expr* right;
+    struct Expr** items;
+    int item_count;
+
+    //per-node caches, valid while eval_epoch matches the pool
+    unsigned eval_epoch;
+    int eval_status;
+    long long eval_value;
+
+    int normal_done;
+    const LinearForm* normal;
+} Expr;
+
+typedef int (*ExprLookup)(void* ctx, const char* name, long long* value);
+
+typedef struct ExprPool ExprPool;
+
+ExprPool* expr_pool_create(void);
+void expr_pool_destroy(ExprPool* pool);
+
+const char* expr_intern(ExprPool* pool, const char* text);
+
+Expr* expr_number(ExprPool* pool, const char* digits);
+Expr* expr_variable(ExprPool* pool, const char* name);
+Expr* expr_unary(ExprPool* pool, ExprKind kind, Expr* operand);
+Expr* expr_binary(ExprPool* pool, ExprKind kind, Expr* left, Expr* right);
+Expr* expr_call(ExprPool* pool, const char* name, Expr** args, int arg_count);
+Expr* expr_tuple(ExprPool* pool, Expr** items, int item_count);
+Expr* expr_case(ExprPool* pool, Expr* subject, Expr** arms, int arm_count);
+
+Expr* expr_parse(ExprPool* pool, const Token* tokens, int* pos, int end);
+Expr* expr_copy(ExprPool* pool, const Expr* e);
+
+void expr_pool_bind(ExprPool* pool, ExprLookup lookup, void* ctx, long long modulus);
+int expr_eval(ExprPool* pool, Expr* e, long long* value);
+const LinearForm* expr_normalize(ExprPool* pool, Expr* e);
+
+int expr_pool_node_count(const ExprPool* pool);
+
+#endif
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fault.h"
+#include "region.h"
+
+//one chain per thread, so contexts running on different threads never share it
+static __thread Fault* active;
+
+void fault_install(Fault* f) {
+    f->out_of_memory = 0;
+    f->offset = -1;
+    f->message[0] = '\0';
+    f->region = region_current();
+    f->outer = active;
+    active = f;
+}
+
+void fault_remove(Fault* f) {
+    if (active == f) active = f->outer;
+}
+
+int fault_active(void) {
+    return active != NULL;
+}
+
+//the innermost recovery point is popped before jumping to it
+void fault_raise(int offset, const char* message) {
+    Fault* f = active;
+    if (!f) {
+        printf("Error: %s\n", message);
+        exit(1);
+    }
+
+    active = f->outer;
+    region_unwind(f->region);
+    f->offset = offset;
+    snprintf(f->message, sizeof(f->message), "%s", message);
+    longjmp(f->env, 1);
+}
+
+void fault_out_of_memory(const char* what) {
+    char message[FAULT_MESSAGE_LEN];
+    snprintf(message, sizeof(message), "Memory allocation failed for %s", what);
+    if (active) active->out_of_memory = 1;
+    fault_raise(-1, message);
+}
+
+void fault_reraise(const Fault* f) {
+    if (f->out_of_memory && active) active->out_of_memory = 1;
+    fault_raise(f->offset, f->message);
+}
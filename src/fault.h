@@ -0,0 +1,32 @@
+#ifndef FAULT_H
+#define FAULT_H
+
+#include <setjmp.h>
+
+#define FAULT_MESSAGE_LEN 256
+
+//neither returns: they jump to the recovery point or exit
+#define FAULT_NORETURN __attribute__((noreturn))
+
+//recovery point for fatal errors on the current thread; with none installed they
+//print the message and exit, which is what the command line wants
+typedef struct Fault {
+    jmp_buf env;
+    int out_of_memory;
+    int offset;
+    char message[FAULT_MESSAGE_LEN];
+    struct Region* region;
+    struct Fault* outer;
+} Fault;
+
+void fault_install(Fault* f);
+void fault_remove(Fault* f);
+int fault_active(void);
+
+FAULT_NORETURN void fault_raise(int offset, const char* message);
+FAULT_NORETURN void fault_out_of_memory(const char* what);
+
+//passes a fault caught at f, already removed, on to the next recovery point
+FAULT_NORETURN void fault_reraise(const Fault* f);
+
+#endif
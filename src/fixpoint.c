@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fixpoint.h"
+
+static void set_error(Evaluator* ev, const char* message, const char* name) {
+    if (ev->error[0] == '\0') snprintf(ev->error, sizeof(ev->error), message, name);
+}
+
+static const Definition* find_callee(const Evaluator* ev, const char* name, int* index) {
+    for (int i = ev->definition_count - 1; i >= 0; i--) {
+        if (ev->definitions[i].name == name) {
+            *index = i;
+            return &ev->definitions[i];
+        }
+    }
+    return NULL;
+}
+
+//system variables an expression reads, directly or through the bodies it calls
+static void collect_inputs(const Evaluator* ev, const FixedPointSystem* sys, Expr* e,
+                           unsigned char* uses, unsigned char* visited) {
+    if (!e) return;
+
+    if (e->kind == EXPR_VARIABLE) {
+        for (int i = 0; i < sys->count; i++) {
+            if (sys->equations[i].name == e->name) uses[i] = 1;
+        }
+    } else if (e->kind == EXPR_CALL) {
+        int index;
+        const Definition* callee = find_callee(ev, e->name, &index);
+        if (callee && !visited[index]) {
+            visited[index] = 1;
+            collect_inputs(ev, sys, callee->body, uses, visited);
+        }
+    }
+
+    collect_inputs(ev, sys, e->left, uses, visited);
+    collect_inputs(ev, sys, e->right, uses, visited);
+    for (int i = 0; i < e->item_count; i++) {
+        collect_inputs(ev, sys, e->items[i], uses, visited);
+    }
+}
+
+//semi-naive iteration: a round only re-evaluates steps whose inputs changed in the
+//round before, and all of a round's steps see the values of the previous round
+int fixed_point_solve(FixedPointSystem* sys, Evaluator* ev, Definition* vars) {
+    if (!sys || !ev || !vars) return -1;
+
+    int n = sys->count;
+    sys->rounds = 0;
+    sys->evaluations = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (!sys->equations[i].initial) {
+            set_error(ev, "'%s' has no initial value", sys->equations[i].name);
+            return -1;
+        }
+        if (eval_expr(ev, sys->equations[i].initial, &vars[i].value) != 0) return -1;
+        vars[i].evaluated = 1;
+    }
+
+    //uses[i * n + j]: the step of equation i reads variable j
+    unsigned char* uses = calloc((size_t)n * n + 1, 1);
+    unsigned char* visited = calloc((size_t)ev->definition_count + 1, 1);
+    unsigned char* dirty = calloc((size_t)n + 1, 1);
+    unsigned char* changed = calloc((size_t)n + 1, 1);
+    RtValue* next = calloc((size_t)n + 1, sizeof(RtValue));
+    if (!uses || !visited || !dirty || !changed || !next) {
+        free(uses);
+        free(visited);
+        free(dirty);
+        free(changed);
+        free(next);
+        set_error(ev, "out of memory solving '%s'", sys->equations[0].name);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (!sys->equations[i].step) continue;
+        memset(visited, 0, (size_t)ev->definition_count + 1);
+        collect_inputs(ev, sys, sys->equations[i].step, uses + (size_t)i * n, visited);
+        dirty[i] = 1;
+    }
+
+    int status = -1;
+    for (int round = 1; round <= sys->max_rounds; round++) {
+        int failed = 0;
+        for (int i = 0; i < n && !failed; i++) {
+            if (!dirty[i]) continue;
+            if (eval_expr(ev, sys->equations[i].step, &next[i]) != 0) {
+                //neither this step nor the ones after it hold a value to release
+                memset(dirty + i, 0, (size_t)(n - i));
+                failed = 1;
+                break;
+            }
+            sys->evaluations++;
+        }
+
+        int any = 0;
+        for (int i = 0; i < n; i++) {
+            changed[i] = 0;
+            if (!dirty[i]) continue;
+
+            if (!failed && !rt_value_equal(&next[i], &vars[i].value)) {
+                rt_value_release(&vars[i].value);
+                vars[i].value = next[i];
+                changed[i] = 1;
+                any = 1;
+            } else {
+                rt_value_release(&next[i]);
+            }
+            memset(&next[i], 0, sizeof(next[i]));
+        }
+
+        if (failed) break;
+        sys->rounds = round;
+        if (!any) {
+            status = 0;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            dirty[i] = 0;
+            if (!sys->equations[i].step) continue;
+            for (int j = 0; j < n && !dirty[i]; j++) {
+                if (changed[j] && uses[(size_t)i * n + j]) dirty[i] = 1;
+            }
+        }
+    }
+
+    if (status != 0 && ev->error[0] == '\0') {
+        snprintf(ev->error, sizeof(ev->error), "no fixed point within %d rounds", sys->max_rounds);
+    }
+
+    free(uses);
+    free(visited);
+    free(dirty);
+    free(changed);
+    free(next);
+    return status;
+}
@@ -0,0 +1,27 @@
+#ifndef FIXPOINT_H
+#define FIXPOINT_H
+
+#include "eval.h"
+
+#define MAX_FIXPOINT_VARS 64
+#define FIXPOINT_DEFAULT_ROUNDS 1000
+
+//x = initial, then x = step until no step changes its variable
+typedef struct {
+    const char* name;
+    Expr* initial;
+    Expr* step;
+} FixedPointEquation;
+
+typedef struct {
+    FixedPointEquation equations[MAX_FIXPOINT_VARS];
+    int count;
+    int max_rounds;
+
+    int rounds;
+    int evaluations;
+} FixedPointSystem;
+
+int fixed_point_solve(FixedPointSystem* sys, Evaluator* ev, Definition* vars);
+
+#endif
@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "gf2.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GF2_HAVE_AVX2 1
+#endif
+
+#define GF2_LANE_WORDS 4
+#define GF2_MAX_K 8
+
+static void xor_portable(uint64_t* dst, const uint64_t* src, int words) {
+    for (int i = 0; i < words; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+#ifdef GF2_HAVE_AVX2
+__attribute__((target("avx2")))
+static void xor_avx2(uint64_t* dst, const uint64_t* src, int words) {
+    int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(a, b));
+    }
+    for (; i < words; i++) {
+        dst[i] ^= src[i];
+    }
+}
+#endif
+
+//the CPU is queried once per process; callers keep the function they get back
+static GF2XorFn xor_fn_resolved = xor_portable;
+static pthread_once_t xor_fn_once = PTHREAD_ONCE_INIT;
+
+static void resolve_xor(void) {
+#ifdef GF2_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) xor_fn_resolved = xor_avx2;
+#endif
+}
+
+GF2XorFn gf2_xor_function(void) {
+    pthread_once(&xor_fn_once, resolve_xor);
+    return xor_fn_resolved;
+}
+
+GF2XorFn gf2_xor_kernel(const char* name) {
+    if (strcmp(name, "portable") == 0) return xor_portable;
+#ifdef GF2_HAVE_AVX2
+    if (strcmp(name, "avx2") == 0) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? xor_avx2 : NULL;
+    }
+#endif
+    return NULL;
+}
+
+static uint64_t* alloc_rows(int rows, int words, void** block) {
+    size_t bytes = (size_t)(rows > 0 ? rows : 1) * words * sizeof(uint64_t);
+    *block = calloc(1, bytes + COEFF_ALIGNMENT - 1);
+    if (!*block) return NULL;
+
+    uintptr_t aligned = ((uintptr_t)*block + COEFF_ALIGNMENT - 1) & ~(uintptr_t)(COEFF_ALIGNMENT - 1);
+    return (uint64_t*)aligned;
+}
+
+int gf2_matrix_init(GF2Matrix* m, int rows, int cols) {
+    if (!m || rows < 0 || cols < 0) return -1;
+
+    memset(m, 0, sizeof(*m));
+
+    int words = (cols + 63) / 64;
+    words = (words + GF2_LANE_WORDS - 1) / GF2_LANE_WORDS * GF2_LANE_WORDS;
+    if (words == 0) words = GF2_LANE_WORDS;
+
+    m->data = alloc_rows(rows, words, &m->block);
+    if (!m->data) return -1;
+
+    m->rows = rows;
+    m->cols = cols;
+    m->words = words;
+    return 0;
+}
+
+void gf2_matrix_free(GF2Matrix* m) {
+    if (!m) return;
+
+    free(m->block);
+    memset(m, 0, sizeof(*m));
+}
+
+int gf2_matrix_from_coeffs(GF2Matrix* m, const CoeffMatrix* coeffs, int rows) {
+    if (!m || !coeffs || rows > coeffs->rows) return -1;
+    if (gf2_matrix_init(m, rows, coeffs->cols) != 0) return -1;
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < coeffs->cols; c++) {
+            if (coeff_get(coeffs, r, c) & 1) gf2_set(m, r, c, 1);
+        }
+    }
+    return 0;
+}
+
+static int choose_k(int n) {
+    int log = 0;
+    while ((1 << (log + 1)) <= n) log++;
+
+    int k = log * 3 / 4;
+    if (k < 1) k = 1;
+    if (k > GF2_MAX_K) k = GF2_MAX_K;
+    return k;
+}
+
+static void swap_rows(GF2Matrix* m, int a, int b) {
+    if (a == b) return;
+
+    uint64_t* ra = gf2_row(m, a);
+    uint64_t* rb = gf2_row(m, b);
+    for (int i = 0; i < m->words; i++) {
+        uint64_t t = ra[i];
+        ra[i] = rb[i];
+        rb[i] = t;
+    }
+}
+
+//fills table[g] with the xor of the rows selected by the bits of g,
+//visiting the entries in Gray code order so each costs one row xor
+static void build_gray_table(uint64_t* table, uint64_t** rows, int kk, int words,
+                             int start, GF2XorFn xor_fn) {
+    memset(table, 0, sizeof(uint64_t) * words);
+
+    for (int i = 1; i < (1 << kk); i++) {
+        int gray = i ^ (i >> 1);
+        int prev = (i - 1) ^ ((i - 1) >> 1);
+        int bit = 0;
+        while (!((gray ^ prev) & (1 << bit))) bit++;
+
+        uint64_t* dst = table + (size_t)gray * words;
+        memcpy(dst + start, table + (size_t)prev * words + start, sizeof(uint64_t) * (words - start));
+        xor_fn(dst + start, rows[bit] + start, words - start);
+    }
+}
+
+//Method of Four Russians elimination: up to k pivots are found at a time and
+//every other row is cleared with a single lookup into their combination table
+int gf2_echelonize(GF2Matrix* m, int reduced, GF2XorFn xor_fn) {
+    if (!m || !xor_fn) return -1;
+
+    int k = choose_k(m->rows < m->cols ? m->rows : m->cols);
+
+    void* table_block;
+    uint64_t* table = alloc_rows(1 << k, m->words, &table_block);
+    if (!table) return -1;
+
+    int pivots[GF2_MAX_K];
+    uint64_t* pivot_rows[GF2_MAX_K];
+    int r = 0, c = 0;
+
+    while (c < m->cols && r < m->rows) {
+        int start = c >> 6;
+        int kk = 0;
+        int j = c;
+
+        for (; j < m->cols && kk < k && r + kk < m->rows; j++) {
+            int found = -1;
+            for (int i = r + kk; i < m->rows && found < 0; i++) {
+                uint64_t* row = gf2_row(m, i);
+                for (int t = 0; t < kk; t++) {
+                    if (gf2_get(m, i, pivots[t])) {
+                        xor_fn(row + start, gf2_row(m, r + t) + start, m->words - start);
+                    }
+                }
+                if (gf2_get(m, i, j)) found = i;
+            }
+            if (found < 0) continue;
+
+            swap_rows(m, found, r + kk);
+            for (int t = 0; t < kk; t++) {
+                if (gf2_get(m, r + t, j)) {
+                    xor_fn(gf2_row(m, r + t) + start, gf2_row(m, r + kk) + start, m->words - start);
+                }
+            }
+            pivots[kk++] = j;
+        }
+
+        if (kk > 0) {
+            for (int t = 0; t < kk; t++) pivot_rows[t] = gf2_row(m, r + t);
+            build_gray_table(table, pivot_rows, kk, m->words, start, xor_fn);
+
+            for (int i = reduced ? 0 : r + kk; i < m->rows; i++) {
+                if (i >= r && i < r + kk) continue;
+
+                int mask = 0;
+                for (int t = 0; t < kk; t++) {
+                    mask |= gf2_get(m, i, pivots[t]) << t;
+                }
+                if (mask) {
+                    xor_fn(gf2_row(m, i) + start, table + (size_t)mask * m->words + start,
+                           m->words - start);
+                }
+            }
+            r += kk;
+        }
+        c = j;
+    }
+
+    free(table_block);
+    return r;
+}
+
+static unsigned read_bits(const uint64_t* row, int col, int k) {
+    int w = col >> 6;
+    int s = col & 63;
+
+    uint64_t v = row[w] >> s;
+    if (s + k > 64) v |= row[w + 1] << (64 - s);
+    return (unsigned)(v & ((1u << k) - 1));
+}
+
+//Method of Four Russians multiplication: c = a * b, k rows of b combined per lookup
+int gf2_multiply(GF2Matrix* c, const GF2Matrix* a, const GF2Matrix* b, GF2XorFn xor_fn) {
+    if (!c || !a || !b || !xor_fn || a->cols != b->rows) return -1;
+    if (gf2_matrix_init(c, a->rows, b->cols) != 0) return -1;
+
+    int k = choose_k(b->rows);
+
+    void* table_block;
+    uint64_t* table = alloc_rows(1 << k, b->words, &table_block);
+    if (!table) {
+        gf2_matrix_free(c);
+        return -1;
+    }
+
+    uint64_t* block_rows[GF2_MAX_K];
+    for (int s = 0; s < a->cols; s += k) {
+        int kk = (a->cols - s < k) ? a->cols - s : k;
+        for (int t = 0; t < kk; t++) block_rows[t] = gf2_row(b, s + t);
+        build_gray_table(table, block_rows, kk, b->words, 0, xor_fn);
+
+        for (int i = 0; i < a->rows; i++) {
+            unsigned idx = read_bits(gf2_row(a, i), s, kk);
+            if (idx) xor_fn(gf2_row(c, i), table + (size_t)idx * b->words, b->words);
+        }
+    }
+
+    free(table_block);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef GF2_H
+#define GF2_H
+
+#include <stdint.h>
+#include "matrix.h"
+
+//bit-packed matrix over GF(2), rows padded to whole 256-bit lanes
+typedef struct {
+    int rows;
+    int cols;
+    int words;
+    uint64_t* data;
+    void* block;
+} GF2Matrix;
+
+int gf2_matrix_init(GF2Matrix* m, int rows, int cols);
+void gf2_matrix_free(GF2Matrix* m);
+int gf2_matrix_from_coeffs(GF2Matrix* m, const CoeffMatrix* coeffs, int rows);
+
+static inline uint64_t* gf2_row(const GF2Matrix* m, int row) {
+    return m->data + (size_t)row * m->words;
+}
+
+static inline int gf2_get(const GF2Matrix* m, int row, int col) {
+    return (int)((gf2_row(m, row)[col >> 6] >> (col & 63)) & 1);
+}
+
+static inline void gf2_set(GF2Matrix* m, int row, int col, int bit) {
+    uint64_t mask = (uint64_t)1 << (col & 63);
+    if (bit) gf2_row(m, row)[col >> 6] |= mask;
+    else gf2_row(m, row)[col >> 6] &= ~mask;
+}
+
+//dst ^= src over whole words, using the widest kernel the CPU supports
+typedef void (*GF2XorFn)(uint64_t* dst, const uint64_t* src, int words);
+GF2XorFn gf2_xor_function(void);
+
+//one kernel by name, "portable" or "avx2"; NULL when the CPU lacks it
+GF2XorFn gf2_xor_kernel(const char* name);
+
+int gf2_echelonize(GF2Matrix* m, int reduced, GF2XorFn xor_fn);
+int gf2_multiply(GF2Matrix* c, const GF2Matrix* a, const GF2Matrix* b, GF2XorFn xor_fn);
+
+#endif
@@ -0,0 +1,721 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hnf.h"
+
+typedef unsigned long long u64;
+
+//residues are taken modulo primes just below 2^31 so products fit in 64 bits
+#define PRIME_START 2147483648ULL
+#define PRIME_BITS 30
+
+int int_matrix_init(IntMatrix* m, int cols) {
+    if (!m || cols <= 0) return -1;
+
+    memset(m, 0, sizeof(*m));
+    m->cols = cols;
+    return 0;
+}
+
+void int_matrix_free(IntMatrix* m) {
+    if (!m) return;
+
+    free(m->entries);
+    memset(m, 0, sizeof(*m));
+}
+
+int int_matrix_append(IntMatrix* m, const long long* row) {
+    if (!m || !row || m->cols <= 0) return -1;
+
+    if (m->rows == m->capacity) {
+        int capacity = m->capacity ? m->capacity * 2 : 8;
+        long long* grown = realloc(m->entries, sizeof(long long) * (size_t)capacity * m->cols);
+        if (!grown) return -1;
+        m->entries = grown;
+        m->capacity = capacity;
+    }
+
+    memcpy(m->entries + (size_t)m->rows * m->cols, row, sizeof(long long) * m->cols);
+    m->rows++;
+    return 0;
+}
+
+static long long entry(const IntMatrix* m, int row, int col) {
+    return m->entries[(size_t)row * m->cols + col];
+}
+
+static u64 pow_mod(u64 base, u64 exp, u64 p) {
+    u64 result = 1;
+    base %= p;
+    while (exp) {
+        if (exp & 1) result = result * base % p;
+        base = base * base % p;
+        exp >>= 1;
+    }
+    return result;
+}
+
+//Miller-Rabin with bases 2, 3, 5, 7 is exact below 3215031751
+static int is_prime(u64 n) {
+    static const u64 bases[] = {2, 3, 5, 7};
+    if (n < 2) return 0;
+    for (int i = 0; i < 4; i++) {
+        if (n % bases[i] == 0) return n == bases[i];
+    }
+
+    u64 d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        u64 x = pow_mod(bases[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+        int witness = 1;
+        for (int r = 1; r < s && witness; r++) {
+            x = x * x % n;
+            if (x == n - 1) witness = 0;
+        }
+        if (witness) return 0;
+    }
+    return 1;
+}
+
+static u64 prime_below(u64 n) {
+    do {
+        n--;
+    } while (!is_prime(n));
+    return n;
+}
+
+static u64 residue(long long x, u64 p) {
+    long long r = x % (long long)p;
+    return r < 0 ? (u64)(r + (long long)p) : (u64)r;
+}
+
+//rank modulo p, with the rows and pivot columns of a minor that is nonsingular mod p
+static int rank_mod_p(const IntMatrix* m, u64 p, int* row_index, int* pivot_col) {
+    int n = m->cols;
+    u64* basis = malloc(sizeof(u64) * (size_t)n * n);
+    u64* row = malloc(sizeof(u64) * n);
+    if (!basis || !row) {
+        free(basis);
+        free(row);
+        return -1;
+    }
+
+    int rank = 0;
+    for (int i = 0; i < m->rows && rank < n; i++) {
+        for (int j = 0; j < n; j++) row[j] = residue(entry(m, i, j), p);
+
+        for (int k = 0; k < rank; k++) {
+            u64 f = row[pivot_col[k]];
+            if (!f) continue;
+            const u64* b = basis + (size_t)k * n;
+            for (int j = 0; j < n; j++) row[j] = (row[j] + (p - f) * b[j]) % p;
+        }
+
+        int c = 0;
+        while (c < n && row[c] == 0) c++;
+        if (c == n) continue;
+
+        u64 inv = pow_mod(row[c], p - 2, p);
+        u64* b = basis + (size_t)rank * n;
+        for (int j = 0; j < n; j++) b[j] = row[j] * inv % p;
+        pivot_col[rank] = c;
+        row_index[rank] = i;
+        rank++;
+    }
+
+    free(basis);
+    free(row);
+    return rank;
+}
+
+static u64 det_mod_p(const long long* minor, int r, u64 p, u64* work) {
+    for (int i = 0; i < r * r; i++) work[i] = residue(minor[i], p);
+
+    u64 det = 1;
+    for (int c = 0; c < r; c++) {
+        int pivot = c;
+        while (pivot < r && work[pivot * r + c] == 0) pivot++;
+        if (pivot == r) return 0;
+
+        if (pivot != c) {
+            for (int j = 0; j < r; j++) {
+                u64 t = work[c * r + j];
+                work[c * r + j] = work[pivot * r + j];
+                work[pivot * r + j] = t;
+            }
+            det = (p - det) % p;
+        }
+
+        u64 x = work[c * r + c];
+        det = det * x % p;
+        u64 inv = pow_mod(x, p - 2, p);
+        for (int i = c + 1; i < r; i++) {
+            u64 f = work[i * r + c] * inv % p;
+            if (!f) continue;
+            for (int j = c; j < r; j++) {
+                work[i * r + j] = (work[i * r + j] + (p - f) * work[c * r + j]) % p;
+            }
+        }
+    }
+    return det;
+}
+
+static int bit_length(u64 x) {
+    int bits = 0;
+    while (x) {
+        bits++;
+        x >>= 1;
+    }
+    return bits;
+}
+
+static u64 value_residue(Value v, u64 p) {
+    Value q = value_from_long((long long)p);
+    Value r;
+    long long x = 0;
+    value_divmod(v, q, NULL, &r);
+    value_to_long(r, &x);
+    value_release(r);
+    value_release(q);
+    return residue(x, p);
+}
+
+//exact |det| of the minor by Chinese remaindering past its Hadamard bound
+static Value minor_determinant(const long long* minor, int r) {
+    int bound = 1;
+    for (int i = 0; i < r; i++) {
+        u64 largest = 0;
+        for (int j = 0; j < r; j++) {
+            long long x = minor[i * r + j];
+            u64 magnitude = x < 0 ? (u64)0 - (u64)x : (u64)x;
+            if (magnitude > largest) largest = magnitude;
+        }
+        bound += bit_length(largest) + (bit_length((u64)r) + 1) / 2;
+    }
+
+    u64* work = malloc(sizeof(u64) * (size_t)r * r);
+    if (!work) return value_from_fixnum(0);
+
+    Value x = value_from_fixnum(0);
+    Value modulus = value_from_fixnum(1);
+    u64 p = PRIME_START;
+    for (int bits = 0; bits <= bound; bits += PRIME_BITS) {
+        p = prime_below(p);
+        u64 a = det_mod_p(minor, r, p, work);
+        u64 xm = value_residue(x, p);
+        u64 mm = value_residue(modulus, p);
+        u64 t = (a + p - xm) % p * pow_mod(mm, p - 2, p) % p;
+
+        Value vt = value_from_long((long long)t);
+        Value vp = value_from_long((long long)p);
+        Value step = value_mul(modulus, vt);
+        Value next = value_add(x, step);
+        Value grown = value_mul(modulus, vp);
+        value_release(vt);
+        value_release(vp);
+        value_release(step);
+        value_release(x);
+        value_release(modulus);
+        x = next;
+        modulus = grown;
+    }
+    free(work);
+
+    //symmetric residue, then the magnitude
+    Value twice = value_add(x, x);
+    if (value_cmp(twice, modulus) > 0) {
+        Value t = value_sub(x, modulus);
+        value_release(x);
+        x = t;
+    }
+    value_release(twice);
+    value_release(modulus);
+
+    if (value_sign(x) < 0) {
+        Value t = value_neg(x);
+        value_release(x);
+        x = t;
+    }
+    return x;
+}
+
+static Value mod_d(Value a, Value d) {
+    Value r;
+    value_divmod(a, d, NULL, &r);
+    if (value_sign(r) < 0) {
+        Value t = value_add(r, d);
+        value_release(r);
+        r = t;
+    }
+    return r;
+}
+
+static void set(Value* slot, Value v) {
+    value_release(*slot);
+    *slot = v;
+}
+
+//g = u*a + v*b for non-negative a and b
+static Value ext_gcd(Value a, Value b, Value* u, Value* v) {
+    Value old_r = value_copy(a), r = value_copy(b);
+    Value old_s = value_from_fixnum(1), s = value_from_fixnum(0);
+    Value old_t = value_from_fixnum(0), t = value_from_fixnum(1);
+
+    while (value_sign(r) != 0) {
+        Value q, rem;
+        value_divmod(old_r, r, &q, &rem);
+        value_release(old_r);
+        old_r = r;
+        r = rem;
+
+        Value qs = value_mul(q, s);
+        Value ns = value_sub(old_s, qs);
+        value_release(qs);
+        value_release(old_s);
+        old_s = s;
+        s = ns;
+
+        Value qt = value_mul(q, t);
+        Value nt = value_sub(old_t, qt);
+        value_release(qt);
+        value_release(old_t);
+        old_t = t;
+        t = nt;
+        value_release(q);
+    }
+
+    value_release(r);
+    value_release(s);
+    value_release(t);
+    *u = old_s;
+    *v = old_t;
+    return old_r;
+}
+
+static Value mul_add(Value a, Value x, Value b, Value y, Value d) {
+    Value ax = value_mul(a, x);
+    Value by = value_mul(b, y);
+    Value sum = value_add(ax, by);
+    Value r = mod_d(sum, d);
+    value_release(ax);
+    value_release(by);
+    value_release(sum);
+    return r;
+}
+
+//unimodular 2x2 step on two rows or columns (stride apart) clearing y[at] into x[at];
+//entries stay reduced mod d, which leaves the ideals they generate unchanged
+static void combine(Value* x, Value* y, int stride, int len, int at, Value d) {
+    Value a = x[at * stride];
+    Value b = y[at * stride];
+    if (value_sign(b) == 0) return;
+
+    if (value_sign(a) != 0) {
+        Value q, rem;
+        value_divmod(b, a, &q, &rem);
+        int exact = value_sign(rem) == 0;
+        value_release(rem);
+        if (exact) {
+            Value neg = value_neg(q);
+            Value one = value_from_fixnum(1);
+            for (int k = 0; k < len; k++) {
+                set(&y[k * stride], mul_add(one, y[k * stride], neg, x[k * stride], d));
+            }
+            value_release(neg);
+            value_release(q);
+            return;
+        }
+        value_release(q);
+    }
+
+    Value u, v;
+    Value g = ext_gcd(a, b, &u, &v);
+    Value a_g, b_g;
+    value_divmod(a, g, &a_g, NULL);
+    value_divmod(b, g, &b_g, NULL);
+    Value neg_b_g = value_neg(b_g);
+
+    for (int k = 0; k < len; k++) {
+        Value nx = mul_add(u, x[k * stride], v, y[k * stride], d);
+        Value ny = mul_add(a_g, y[k * stride], neg_b_g, x[k * stride], d);
+        set(&x[k * stride], nx);
+        set(&y[k * stride], ny);
+    }
+
+    value_release(g);
+    value_release(u);
+    value_release(v);
+    value_release(a_g);
+    value_release(b_g);
+    value_release(neg_b_g);
+}
+
+static Value* value_matrix(int rows, int cols) {
+    Value* m = malloc(sizeof(Value) * ((size_t)rows * cols + 1));
+    if (!m) return NULL;
+    for (size_t i = 0; i < (size_t)rows * cols; i++) m[i] = value_from_fixnum(0);
+    return m;
+}
+
+static void value_matrix_free(Value* m, int rows, int cols) {
+    if (!m) return;
+    for (size_t i = 0; i < (size_t)rows * cols; i++) value_release(m[i]);
+    free(m);
+}
+
+static void swap_values(Value* a, Value* b) {
+    Value t = *a;
+    *a = *b;
+    *b = t;
+}
+
+//Smith form over Z/dZ; diag[k] generates the ideal of the k-th invariant factor
+static void smith_mod(Value* a, int rows, int cols, Value d, Value* diag) {
+    int count = rows < cols ? rows : cols;
+
+    for (int k = 0; k < count; k++) {
+        int pi = -1, pj = -1;
+        for (int i = k; i < rows; i++) {
+            for (int j = k; j < cols; j++) {
+                Value x = a[i * cols + j];
+                if (value_sign(x) != 0 && (pi < 0 || value_cmp(x, a[pi * cols + pj]) < 0)) {
+                    pi = i;
+                    pj = j;
+                }
+            }
+        }
+        if (pi < 0) {
+            for (int i = k; i < count; i++) diag[i] = value_from_fixnum(0);
+            return;
+        }
+
+        for (int j = 0; j < cols; j++) swap_values(&a[k * cols + j], &a[pi * cols + j]);
+        for (int i = 0; i < rows; i++) swap_values(&a[i * cols + k], &a[i * cols + pj]);
+
+        for (;;) {
+            for (int i = k + 1; i < rows; i++) {
+                combine(&a[k * cols], &a[i * cols], 1, cols, k, d);
+            }
+            for (int j = k + 1; j < cols; j++) {
+                combine(&a[k], &a[j], cols, rows, k, d);
+            }
+
+            int clean = 1;
+            for (int i = k + 1; i < rows && clean; i++) {
+                if (value_sign(a[i * cols + k]) != 0) clean = 0;
+            }
+            if (!clean) continue;
+
+            //the pivot must divide what is left; otherwise pull the offending row in
+            Value g = value_gcd(a[k * cols + k], d);
+            int offender = -1;
+            for (int i = k + 1; i < rows && offender < 0; i++) {
+                for (int j = k + 1; j < cols; j++) {
+                    Value rem;
+                    value_divmod(a[i * cols + j], g, NULL, &rem);
+                    int divides = value_sign(rem) == 0;
+                    value_release(rem);
+                    if (!divides) {
+                        offender = i;
+                        break;
+                    }
+                }
+            }
+            value_release(g);
+            if (offender < 0) break;
+
+            for (int j = k; j < cols; j++) {
+                Value sum = value_add(a[k * cols + j], a[offender * cols + j]);
+                set(&a[k * cols + j], mod_d(sum, d));
+                value_release(sum);
+            }
+        }
+
+        diag[k] = value_copy(a[k * cols + k]);
+    }
+}
+
+static Value floor_div(Value a, Value b) {
+    Value q, r;
+    value_divmod(a, b, &q, &r);
+    if (value_sign(r) < 0) {
+        Value one = value_from_fixnum(1);
+        Value t = value_sub(q, one);
+        value_release(q);
+        q = t;
+    }
+    value_release(r);
+    return q;
+}
+
+//Hermite form of a full-rank lattice containing d*Z^n, working modulo d and
+//dividing d by each pivot found (Domich, Kannan and Trotter)
+static Value* hnf_mod(Value* w, int rows, int n, Value d) {
+    Value* h = value_matrix(n, n);
+    Value* p = value_matrix(1, n);
+    if (!h || !p) {
+        value_matrix_free(h, n, n);
+        value_matrix_free(p, 1, n);
+        return NULL;
+    }
+
+    Value r = value_copy(d);
+    for (int j = 0; j < n; j++) {
+        for (int k = 0; k < n; k++) set(&p[k], value_from_fixnum(0));
+
+        for (int i = 0; i < rows; i++) {
+            Value* row = &w[i * n];
+            for (int k = j; k < n; k++) set(&row[k], mod_d(row[k], r));
+            combine(p, row, 1, n, j, r);
+        }
+
+        Value u, v;
+        Value g = ext_gcd(p[j], r, &u, &v);
+        for (int k = j + 1; k < n; k++) {
+            Value x = value_mul(u, p[k]);
+            set(&h[j * n + k], mod_d(x, r));
+            value_release(x);
+        }
+        set(&h[j * n + j], g);
+
+        Value next;
+        value_divmod(r, g, &next, NULL);
+        value_release(r);
+        value_release(u);
+        value_release(v);
+        r = next;
+    }
+    value_release(r);
+    value_matrix_free(p, 1, n);
+
+    //reduce above the diagonal into [0, pivot)
+    for (int i = n - 2; i >= 0; i--) {
+        for (int j = i + 1; j < n; j++) {
+            Value q = floor_div(h[i * n + j], h[j * n + j]);
+            if (value_sign(q) != 0) {
+                for (int k = j; k < n; k++) {
+                    Value t = value_mul(q, h[j * n + k]);
+                    Value x = value_sub(h[i * n + k], t);
+                    set(&h[i * n + k], x);
+                    value_release(t);
+                }
+            }
+            value_release(q);
+        }
+    }
+    return h;
+}
+
+static int larger_first(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return x > y ? -1 : x < y;
+}
+
+//bits of a Hadamard bound per nonzero row, largest first; returns how many rows are nonzero
+static int row_bounds(const IntMatrix* m, int* bits) {
+    int count = 0;
+    for (int i = 0; i < m->rows; i++) {
+        u64 largest = 0;
+        for (int j = 0; j < m->cols; j++) {
+            long long x = entry(m, i, j);
+            u64 magnitude = x < 0 ? (u64)0 - (u64)x : (u64)x;
+            if (magnitude > largest) largest = magnitude;
+        }
+        if (largest) bits[count++] = bit_length(largest) + (bit_length((u64)m->cols) + 1) / 2;
+    }
+    qsort(bits, count, sizeof(int), larger_first);
+    return count;
+}
+
+//bits bounding any k x k minor: the k largest row bounds together
+static int minor_bound(const int* bits, int k) {
+    int bound = 1;
+    for (int i = 0; i < k; i++) bound += bits[i];
+    return bound;
+}
+
+int int_matrix_cokernel(const IntMatrix* m, Cokernel* out) {
+    if (!m || !out) return -1;
+
+    int n = m->cols;
+    memset(out, 0, sizeof(*out));
+    out->cols = n;
+    out->determinant = value_from_fixnum(1);
+
+    int* row_index = malloc(sizeof(int) * (n + 1));
+    int* pivot_col = malloc(sizeof(int) * (n + 1));
+    int* best_rows = malloc(sizeof(int) * (n + 1));
+    int* best_cols = malloc(sizeof(int) * (n + 1));
+    int* bits = malloc(sizeof(int) * (m->rows + 1));
+    if (!row_index || !pivot_col || !best_rows || !best_cols || !bits) {
+        free(row_index);
+        free(pivot_col);
+        free(best_rows);
+        free(best_cols);
+        free(bits);
+        return -1;
+    }
+
+    //the rank over Q is at least the rank modulo any prime, and every prime at
+    //which it is lower divides all larger minors; once the primes tried outweigh
+    //the Hadamard bound of the next size up, those minors are zero and the rank is exact
+    int nonzero = row_bounds(m, bits);
+    int rank = 0;
+    int prime_bits = 0;
+    u64 p = PRIME_START;
+    while (rank < n && rank < nonzero && prime_bits <= minor_bound(bits, rank + 1)) {
+        p = prime_below(p);
+        int r = rank_mod_p(m, p, row_index, pivot_col);
+        if (r < 0) {
+            rank = -1;
+            break;
+        }
+        if (r > rank) {
+            rank = r;
+            memcpy(best_rows, row_index, sizeof(int) * r);
+            memcpy(best_cols, pivot_col, sizeof(int) * r);
+        }
+        prime_bits += PRIME_BITS;
+    }
+    free(row_index);
+    free(pivot_col);
+    free(bits);
+
+    int status = rank < 0 ? -1 : 0;
+    if (rank > 0) {
+        long long* minor = malloc(sizeof(long long) * (size_t)rank * rank);
+        if (minor) {
+            for (int i = 0; i < rank; i++) {
+                for (int j = 0; j < rank; j++) minor[i * rank + j] = entry(m, best_rows[i], best_cols[j]);
+            }
+            value_release(out->determinant);
+            out->determinant = minor_determinant(minor, rank);
+            free(minor);
+        }
+        if (!minor || value_sign(out->determinant) == 0) status = -1;
+    }
+    free(best_rows);
+    free(best_cols);
+
+    if (status != 0 || rank == 0) {
+        out->rank = rank > 0 ? rank : 0;
+        return status;
+    }
+    out->rank = rank;
+
+    Value d = out->determinant;
+    Value* w = value_matrix(m->rows, n);
+    out->invariants = value_matrix(1, rank);
+    if (!w || !out->invariants) {
+        value_matrix_free(w, m->rows, n);
+        return -1;
+    }
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < n; j++) {
+            Value x = value_from_long(entry(m, i, j));
+            set(&w[i * n + j], mod_d(x, d));
+            value_release(x);
+        }
+    }
+
+    //full rank: d*Z^n lies in the lattice, so its Hermite form is computable mod d
+    Value* a = w;
+    int rows = m->rows;
+    if (rank == n) {
+        out->hnf = hnf_mod(w, m->rows, n, d);
+        if (out->hnf) {
+            value_matrix_free(w, m->rows, n);
+            w = NULL;
+            a = value_matrix(n, n);
+            rows = n;
+            for (int i = 0; a && i < n * n; i++) set(&a[i], mod_d(out->hnf[i], d));
+        }
+    }
+    if (!a) return -1;
+
+    int count = rows < n ? rows : n;
+    Value* diag = malloc(sizeof(Value) * count);
+    if (!diag) {
+        value_matrix_free(a, rows, n);
+        return -1;
+    }
+    smith_mod(a, rows, n, d, diag);
+
+    //ideal generators back to invariant factors: gcd(0, d) = d
+    for (int i = 0; i < count; i++) {
+        if (i < rank) out->invariants[i] = value_gcd(diag[i], d);
+        value_release(diag[i]);
+    }
+    free(diag);
+    value_matrix_free(a, rows, n);
+    return 0;
+}
+
+void cokernel_free(Cokernel* c) {
+    if (!c) return;
+
+    value_release(c->determinant);
+    if (c->invariants) {
+        for (int i = 0; i < c->rank; i++) value_release(c->invariants[i]);
+        free(c->invariants);
+    }
+    value_matrix_free(c->hnf, c->cols, c->cols);
+    memset(c, 0, sizeof(*c));
+}
+
+static int append(char** buf, size_t* len, size_t* cap, const char* text) {
+    size_t n = strlen(text);
+    if (*len + n + 1 > *cap) {
+        size_t grown = (*len + n + 1) * 2;
+        char* next = realloc(*buf, grown);
+        if (!next) return -1;
+        *buf = next;
+        *cap = grown;
+    }
+    memcpy(*buf + *len, text, n + 1);
+    *len += n;
+    return 0;
+}
+
+//"Z^2 + Z/2 + Z/6", or "0" for the trivial module
+char* cokernel_to_string(const Cokernel* c) {
+    if (!c) return NULL;
+
+    char* buf = NULL;
+    size_t len = 0, cap = 0;
+    int terms = 0;
+    int ok = 1;
+
+    int free_rank = c->cols - c->rank;
+    if (free_rank > 0) {
+        char small[32];
+        if (free_rank == 1) strcpy(small, "Z");
+        else snprintf(small, sizeof(small), "Z^%d", free_rank);
+        ok = append(&buf, &len, &cap, small) == 0;
+        terms++;
+    }
+
+    Value one = value_from_fixnum(1);
+    for (int i = 0; ok && c->invariants && i < c->rank; i++) {
+        if (value_cmp(c->invariants[i], one) == 0) continue;
+        char* digits = value_to_string(c->invariants[i]);
+        ok = digits && (terms == 0 || append(&buf, &len, &cap, " + ") == 0) &&
+             append(&buf, &len, &cap, "Z/") == 0 && append(&buf, &len, &cap, digits) == 0;
+        free(digits);
+        terms++;
+    }
+
+    if (ok && terms == 0) ok = append(&buf, &len, &cap, "0") == 0;
+    if (!ok) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
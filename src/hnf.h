@@ -0,0 +1,35 @@
+#ifndef HNF_H
+#define HNF_H
+
+#include "value.h"
+
+//integer presentation: one row per relation over the module's generators
+typedef struct {
+    int rows;
+    int cols;
+    int capacity;
+    long long* entries;
+} IntMatrix;
+
+int int_matrix_init(IntMatrix* m, int cols);
+void int_matrix_free(IntMatrix* m);
+int int_matrix_append(IntMatrix* m, const long long* row);
+
+//Z^cols / rowspace, found with every entry kept below a determinant multiple
+typedef struct {
+    int cols;
+    int rank;
+    Value determinant;
+
+    //rank invariant factors, each dividing the next
+    Value* invariants;
+
+    //cols x cols Hermite form of the relations when they have full rank
+    Value* hnf;
+} Cokernel;
+
+int int_matrix_cokernel(const IntMatrix* m, Cokernel* out);
+void cokernel_free(Cokernel* c);
+char* cokernel_to_string(const Cokernel* c);
+
+#endif
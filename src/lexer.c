@@ -18,7 +18,9 @@ static const KeywordMapping KEYWORDS[] = {
     {"in", TOKEN_IN},
     {"integers_mod", TOKEN_INTEGERS_MOD},
     {"rationals", TOKEN_RATIONALS},
+    {"integers", TOKEN_INTEGERS},
     {"free_module", TOKEN_FREE_MODULE},
+    {"import", TOKEN_IMPORT},
     {"define", TOKEN_DEFINE},
     {"as", TOKEN_AS},
     {"where", TOKEN_WHERE},
@@ -54,13 +56,16 @@ static TokenType get_keyword_type(const char* value) {
     return TOKEN_IDENTIFIER;
 }
 
-static int add_token(Token* tokens, int* t, TokenType type, const char* value, size_t len) {
+static int add_token(Token* tokens, int* t, TokenType type, const char* value, size_t len,
+                     int offset, int length) {
     if (*t >= MAX_TOKENS - 1) {
         return -1;
 
     }
 
     tokens[*t].type = type;
+    tokens[*t].offset = offset;
+    tokens[*t].length = length;
     if (len > 0) {
         strncpy(tokens[*t].value, value, len);
         tokens[*t].value[len] = '\0';
@@ -71,7 +76,7 @@ static int add_token(Token* tokens, int* t, TokenType type, const char* value, s
     return 0;
 }
 
-int tokenize(const char* input, Token* tokens, int* token_count) {
+int tokenize(const char* input, Token* tokens, int* token_count, FILE* warnings) {
     int i = 0, t = 0;
 
     while (input[i] && t < MAX_TOKENS - 1) {
@@ -113,7 +118,7 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
             identifier[len] = '\0';
 
             TokenType type = get_keyword_type(identifier);
-            if (add_token(tokens, &t, type, identifier, len) != 0) {
+            if (add_token(tokens, &t, type, identifier, len, start, i - start) != 0) {
                 return -1;
             }
             continue;
@@ -129,7 +134,7 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
                 len = MAX_TOKEN_LEN - 1;
             }
 
-            if (add_token(tokens, &t, TOKEN_NUMBER, &input[start], len) != 0) {
+            if (add_token(tokens, &t, TOKEN_NUMBER, &input[start], len, start, i - start) != 0) {
                 return -1;
             }
             continue;
@@ -146,7 +151,7 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
                 len = MAX_TOKEN_LEN - 1;
             }
 
-            if (add_token(tokens, &t, TOKEN_STRING, &input[start], len) != 0) {
+            if (add_token(tokens, &t, TOKEN_STRING, &input[start], len, start, i - start) != 0) {
                 return -1;
             }
             if (input[i] == '"') i++;
@@ -154,22 +159,22 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
         }
 
         if (input[i] == '=' && input[i+1] == '=') {
-            if (add_token(tokens, &t, TOKEN_EQ, "==", 2) != 0) return -1;
+            if (add_token(tokens, &t, TOKEN_EQ, "==", 2, i, 2) != 0) return -1;
             i += 2;
             continue;
         }
         if (input[i] == '!' && input[i+1] == '=') {
-            if (add_token(tokens, &t, TOKEN_NE, "!=", 2) != 0) return -1;
+            if (add_token(tokens, &t, TOKEN_NE, "!=", 2, i, 2) != 0) return -1;
             i += 2;
             continue;
         }
         if (input[i] == '<' && input[i+1] == '=') {
-            if (add_token(tokens, &t, TOKEN_LE, "<=", 2) != 0) return -1;
+            if (add_token(tokens, &t, TOKEN_LE, "<=", 2, i, 2) != 0) return -1;
             i += 2;
             continue;
         }
         if (input[i] == '>' && input[i+1] == '=') {
-            if (add_token(tokens, &t, TOKEN_GE, ">=", 2) != 0) return -1;
+            if (add_token(tokens, &t, TOKEN_GE, ">=", 2, i, 2) != 0) return -1;
             i += 2;
             continue;
         }
@@ -182,7 +187,7 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
             case '+': type = TOKEN_PLUS; break;
             case '-':
                 if (input[i+1] == '>') {
-                    if (add_token(tokens, &t, TOKEN_ARROW, "->", 2) != 0) return -1;
+                    if (add_token(tokens, &t, TOKEN_ARROW, "->", 2, i, 2) != 0) return -1;
                     i += 2;
                     continue;
                 } else {
@@ -207,18 +212,18 @@ int tokenize(const char* input, Token* tokens, int* token_count) {
             case '.': type = TOKEN_DOT; break;
             default:
 
-                printf("Warning: Unknown character '%c' skipped\n", input[i]);
+                if (warnings) fprintf(warnings, "Warning: Unknown character '%c' skipped\n", input[i]);
                 i++;
                 continue;
         }
 
-        if (add_token(tokens, &t, type, single_char, 1) != 0) {
+        if (add_token(tokens, &t, type, single_char, 1, i, 1) != 0) {
             return -1;
         }
         i++;
     }
 
-    if (add_token(tokens, &t, TOKEN_EOF, "", 0) != 0) {
+    if (add_token(tokens, &t, TOKEN_EOF, "", 0, i, 0) != 0) {
         return -1;
     }
     *token_count = t;
@@ -1,6 +1,8 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stdio.h>
+
 #define MAX_TOKENS 2000
 #define MAX_TOKEN_LEN 100
 #define MAX_IDENTIFIER_LEN 48
@@ -12,7 +14,7 @@ typedef enum {
     TOKEN_MINUS, TOKEN_STAR, TOKEN_SLASH, TOKEN_MOD, TOKEN_LPAREN,
     TOKEN_RPAREN, TOKEN_LBRACE, TOKEN_RBRACE, TOKEN_COMMA, TOKEN_SEMICOLON,
     TOKEN_ARROW, TOKEN_EOF, TOKEN_NUMBER, TOKEN_IN, TOKEN_INTEGERS_MOD,
-    TOKEN_RATIONALS, TOKEN_FREE_MODULE, TOKEN_STRING,
+    TOKEN_RATIONALS, TOKEN_FREE_MODULE, TOKEN_STRING, TOKEN_IMPORT, TOKEN_INTEGERS,
 
     //algebraic control structures
     TOKEN_DEFINE, TOKEN_AS, TOKEN_WHERE, TOKEN_CASE, TOKEN_OF,
@@ -31,8 +33,11 @@ typedef enum {
 typedef struct {
     TokenType type;
     char value[MAX_TOKEN_LEN];
+    int offset;
+    int length;
 } Token;
 
-int tokenize(const char* input, Token* tokens, int* token_count);
+//skipped characters are reported to warnings, if given
+int tokenize(const char* input, Token* tokens, int* token_count, FILE* warnings);
 
 #endif
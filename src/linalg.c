@@ -0,0 +1,201 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "linalg.h"
+#include "gf2.h"
+#include "modular.h"
+
+static long long* copy_rows(const CoeffMatrix* m, int rows) {
+    long long* work = malloc(sizeof(long long) * (size_t)(rows > 0 ? rows : 1) * m->cols);
+    if (!work) return NULL;
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < m->cols; c++) {
+            work[(size_t)r * m->cols + c] = coeff_get(m, r, c);
+        }
+    }
+    return work;
+}
+
+static int rank_gf2(const CoeffMatrix* m, int rows) {
+    GF2Matrix bits;
+    if (gf2_matrix_from_coeffs(&bits, m, rows) != 0) return -1;
+
+    int rank = gf2_echelonize(&bits, 0, gf2_xor_function());
+    gf2_matrix_free(&bits);
+    return rank;
+}
+
+//pivots must be units, so over a composite modulus this counts unit pivots
+static int rank_mod(const CoeffMatrix* m, int rows, long long p) {
+    long long* a = copy_rows(m, rows);
+    if (!a) return -1;
+
+    int cols = m->cols;
+    int rank = 0;
+
+    for (int c = 0; c < cols && rank < rows; c++) {
+        int pivot = -1;
+        long long inv = 0;
+        for (int r = rank; r < rows; r++) {
+            inv = mod_inverse(a[(size_t)r * cols + c], p);
+            if (inv) {
+                pivot = r;
+                break;
+            }
+        }
+        if (pivot < 0) continue;
+
+        long long* prow = a + (size_t)pivot * cols;
+        if (pivot != rank) {
+            long long* rrow = a + (size_t)rank * cols;
+            for (int j = 0; j < cols; j++) {
+                long long t = prow[j]; prow[j] = rrow[j]; rrow[j] = t;
+            }
+            prow = rrow;
+        }
+
+        for (int j = c; j < cols; j++) prow[j] = mod_mul(prow[j], inv, p);
+
+        for (int r = rank + 1; r < rows; r++) {
+            long long* row = a + (size_t)r * cols;
+            long long f = row[c];
+            if (!f) continue;
+            for (int j = c; j < cols; j++) {
+                row[j] = mod_sub(row[j], mod_mul(f, prow[j], p), p);
+            }
+        }
+        rank++;
+    }
+
+    free(a);
+    return rank;
+}
+
+//elimination on Montgomery-form entries, pivots must be invertible
+static int rank_mont(const CoeffMatrix* m, int rows, const MontContext* mont) {
+    int n = mont->limbs;
+    int cols = m->cols;
+    size_t row_limbs = (size_t)cols * n;
+
+    limb_t* a = malloc(sizeof(limb_t) * row_limbs * rows);
+    if (!a) return -1;
+    for (int r = 0; r < rows; r++) {
+        memcpy(a + r * row_limbs, coeff_limbs(m, r, 0), sizeof(limb_t) * row_limbs);
+    }
+
+    limb_t inv[MONT_MAX_LIMBS];
+    limb_t t[MONT_MAX_LIMBS];
+    int rank = 0;
+
+    for (int c = 0; c < cols && rank < rows; c++) {
+        int pivot = -1;
+        for (int r = rank; r < rows; r++) {
+            if (mont_inverse(mont, inv, a + r * row_limbs + (size_t)c * n) == 0) {
+                pivot = r;
+                break;
+            }
+        }
+        if (pivot < 0) continue;
+
+        limb_t* prow = a + rank * row_limbs;
+        if (pivot != rank) {
+            limb_t* other = a + pivot * row_limbs;
+            for (size_t j = 0; j < row_limbs; j++) {
+                limb_t x = prow[j]; prow[j] = other[j]; other[j] = x;
+            }
+        }
+
+        for (int j = c; j < cols; j++) {
+            mont_mul(mont, prow + (size_t)j * n, prow + (size_t)j * n, inv);
+        }
+
+        for (int r = rank + 1; r < rows; r++) {
+            limb_t* row = a + r * row_limbs;
+            limb_t f[MONT_MAX_LIMBS];
+            memcpy(f, row + (size_t)c * n, sizeof(limb_t) * n);
+            if (mont_is_zero(mont, f)) continue;
+
+            for (int j = c; j < cols; j++) {
+                mont_mul(mont, t, f, prow + (size_t)j * n);
+                mont_sub(mont, row + (size_t)j * n, row + (size_t)j * n, t);
+            }
+        }
+        rank++;
+    }
+
+    free(a);
+    return rank;
+}
+
+static int checked_mul(long long a, long long b, long long* out) {
+    if (a == 0 || b == 0) {
+        *out = 0;
+        return 0;
+    }
+    if ((a == -1 && b == LLONG_MIN) || (b == -1 && a == LLONG_MIN)) return -1;
+    long long product = a * b;
+    if (product / b != a) return -1;
+    *out = product;
+    return 0;
+}
+
+//fraction-free (Bareiss) elimination, -1 when an entry overflows
+static int rank_rational(const CoeffMatrix* m, int rows) {
+    long long* a = copy_rows(m, rows);
+    if (!a) return -1;
+
+    int cols = m->cols;
+    int rank = 0;
+    long long prev = 1;
+
+    for (int c = 0; c < cols && rank < rows; c++) {
+        int pivot = -1;
+        for (int r = rank; r < rows; r++) {
+            if (a[(size_t)r * cols + c] != 0) {
+                pivot = r;
+                break;
+            }
+        }
+        if (pivot < 0) continue;
+
+        if (pivot != rank) {
+            for (int j = 0; j < cols; j++) {
+                long long t = a[(size_t)pivot * cols + j];
+                a[(size_t)pivot * cols + j] = a[(size_t)rank * cols + j];
+                a[(size_t)rank * cols + j] = t;
+            }
+        }
+
+        long long* prow = a + (size_t)rank * cols;
+        for (int r = rank + 1; r < rows; r++) {
+            long long* row = a + (size_t)r * cols;
+            for (int j = c + 1; j < cols; j++) {
+                long long x, y;
+                if (checked_mul(prow[c], row[j], &x) != 0 ||
+                    checked_mul(row[c], prow[j], &y) != 0 ||
+                    (y < 0 && x > LLONG_MAX + y) || (y > 0 && x < LLONG_MIN + y)) {
+                    free(a);
+                    return -1;
+                }
+                row[j] = (x - y) / prev;
+            }
+            row[c] = 0;
+        }
+        prev = prow[c];
+        rank++;
+    }
+
+    free(a);
+    return rank;
+}
+
+int coeff_matrix_rank(const CoeffMatrix* m, int rows, long long modulus, const MontContext* mont) {
+    if (!m || rows < 0 || rows > m->rows) return -1;
+    if (rows == 0 || m->cols == 0) return 0;
+
+    if (mont) return rank_mont(m, rows, mont);
+    if (modulus == 2) return rank_gf2(m, rows);
+    if (modulus > 0) return rank_mod(m, rows, modulus);
+    return rank_rational(m, rows);
+}
@@ -0,0 +1,9 @@
+#ifndef LINALG_H
+#define LINALG_H
+
+#include "matrix.h"
+#include "mont.h"
+
+int coeff_matrix_rank(const CoeffMatrix* m, int rows, long long modulus, const MontContext* mont);
+
+#endif
@@ -1,10 +1,43 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "parser.h"
+#include "unit.h"
+#include "check.h"
+#include "store.h"
+#include "summary.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <filename.sz>\n", argv[0]);
+    const char* filename = NULL;
+    const char* profile_path = NULL;
+    double check_error = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            profile_path = "profile.folded";
+        } else if (strncmp(argv[i], "--profile=", 10) == 0 && argv[i][10]) {
+            profile_path = argv[i] + 10;
+        } else if (strcmp(argv[i], "--fast-check") == 0) {
+            check_error = CHECK_DEFAULT_ERROR;
+        } else if (strncmp(argv[i], "--fast-check=", 13) == 0) {
+            char* end;
+            check_error = strtod(argv[i] + 13, &end);
+            if (*end || !(check_error > 0 && check_error < 1)) {
+                printf("Error: --fast-check needs an error probability between 0 and 1\n");
+                return 1;
+            }
+        } else if (!filename) {
+            filename = argv[i];
+        } else {
+            filename = NULL;
+            break;
+        }
+    }
+
+    if (!filename) {
+        printf("Usage: %s [--profile[=stacks.folded]] [--fast-check[=error]] <filename.sz>\n", argv[0]);
         printf("Example: %s test.sz\n", argv[0]);
         return 1;
     }
@@ -12,31 +45,47 @@ int main(int argc, char* argv[]) {
     printf("Syzygy Algebraic Interpreter Improved (SAII)\n");
     printf("==================================\n\n");
 
-    char* program = read_file(argv[1]);
-    if (!program) {
+    UnitGraph* graph = unit_graph_load(filename);
+    if (!graph) {
         return 1;
     }
+    unit_graph_compile_imports(graph);
 
-    printf("Parsing file: %s\n", argv[1]);
+    printf("Parsing file: %s\n", filename);
     printf("----------------------------------------\n");
 
-    Parser* parser = parser_create();
-    if (!parser) {
-        free(program);
-        return 1;
+    Parser* parser = graph->units[0].parser;
+
+    Profiler* profiler = NULL;
+    if (profile_path) {
+        profiler = profiler_create();
+        if (!profiler) {
+            printf("Error: Memory allocation failed for profiler\n");
+            unit_graph_destroy(graph);
+            return 1;
+        }
+        parser->profiler = profiler;
     }
 
-    int token_count;
-    if (tokenize(program, parser->tokens, &token_count) != 0) {
-        free(program);
-        parser_destroy(parser);
-        return 1;
+    FastCheck* checker = NULL;
+    if (check_error > 0) {
+        checker = fast_check_create(check_error, (uint64_t)time(NULL) * 0x9E3779B97F4A7C15ULL ^ (uint64_t)getpid());
+        if (!checker) {
+            printf("Error: Memory allocation failed for fast check\n");
+            profiler_destroy(profiler);
+            unit_graph_destroy(graph);
+            return 1;
+        }
+        parser->fast_check = checker;
     }
-    parser->size = token_count;
 
-    printf("Tokens found: %d\n", token_count);
+    printf("Tokens found: %d\n", parser->size);
     printf("----------------------------------------\n");
 
+    ResultStore store;
+    result_store_init(&store, graph->cache_dir);
+    parser->store = &store;
+
     parse(parser);
 
     printf("----------------------------------------\n");
@@ -44,9 +93,40 @@ int main(int argc, char* argv[]) {
     printf("Structures defined:\n");
     printf("  Rings: %d\n", parser->ring_count);
     printf("  Modules: %d\n", parser->module_count);
+    for (int i = 0; i < parser->module_count; i++) {
+        Module* module = &parser->modules[i];
+        StoreKey key = module_store_key(module);
+        size_t len;
+        char* summary = result_store_load(&store, key, &len);
+        if (!summary) {
+            summary = module_summary(module, &len);
+            if (summary) result_store_save(&store, key, summary, len);
+        }
+        printf("    %s: %s", module->name, summary ? summary : "summary unavailable\n");
+        free(summary);
+    }
+    printf("  Relations: %d (%d shared expression nodes)\n",
+           parser->relation_count, expr_pool_node_count(parser->exprs));
+    if (store.hits + store.misses > 0) {
+        printf("  Result cache: %d hit(s), %d miss(es)\n", store.hits, store.misses);
+    }
+    if (checker) {
+        fast_check_report(checker, stdout);
+        fast_check_destroy(checker);
+    }
+
+    if (profiler) {
+        printf("----------------------------------------\n");
+        profile_report(profiler, stdout);
+        if (profile_write_collapsed(profiler, profile_path) == 0) {
+            printf("Collapsed stacks written to %s\n", profile_path);
+        } else {
+            printf("Warning: Cannot write collapsed stacks to %s\n", profile_path);
+        }
+        profiler_destroy(profiler);
+    }
 
-    free(program);
-    parser_destroy(parser);
+    unit_graph_destroy(graph);
 
     return 0;
 }
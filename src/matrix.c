@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+
+int coeff_width_for_modulus(long long modulus) {
+    if (modulus > 0 && modulus <= 256) return 1;
+    if (modulus > 0 && modulus <= 65536) return 2;
+    if (modulus > 4294967296LL) return 8;
+    return 4;
+}
+
+int coeff_matrix_init(CoeffMatrix* m, int rows, int cols, int elem_size, int is_signed) {
+    if (!m || rows < 0 || cols < 0) return -1;
+    if (elem_size != 1 && elem_size != 2 && elem_size != 4 && (elem_size <= 0 || elem_size % 8 != 0)) {
+        return -1;
+    }
+
+    memset(m, 0, sizeof(*m));
+
+    size_t stride = (size_t)cols * elem_size;
+    stride = (stride + COEFF_ALIGNMENT - 1) & ~(size_t)(COEFF_ALIGNMENT - 1);
+    if (stride == 0) stride = COEFF_ALIGNMENT;
+
+    size_t bytes = stride * (size_t)(rows > 0 ? rows : 1);
+    void* block = calloc(1, bytes + COEFF_ALIGNMENT - 1);
+    if (!block) return -1;
+
+    uintptr_t aligned = ((uintptr_t)block + COEFF_ALIGNMENT - 1) & ~(uintptr_t)(COEFF_ALIGNMENT - 1);
+
+    m->rows = rows;
+    m->cols = cols;
+    m->elem_size = elem_size;
+    m->is_signed = is_signed;
+    m->stride = stride;
+    m->data = (unsigned char*)aligned;
+    m->block = block;
+    return 0;
+}
+
+void coeff_matrix_free(CoeffMatrix* m) {
+    if (!m) return;
+
+    free(m->block);
+    memset(m, 0, sizeof(*m));
+}
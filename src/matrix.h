@@ -0,0 +1,59 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COEFF_ALIGNMENT 64
+
+//dense row-major coefficients, every row starts on a cache line
+typedef struct {
+    int rows;
+    int cols;
+    int elem_size;
+    int is_signed;
+    size_t stride;
+    unsigned char* data;
+    void* block;
+} CoeffMatrix;
+
+int coeff_width_for_modulus(long long modulus);
+
+int coeff_matrix_init(CoeffMatrix* m, int rows, int cols, int elem_size, int is_signed);
+void coeff_matrix_free(CoeffMatrix* m);
+
+static inline unsigned char* coeff_row(const CoeffMatrix* m, int row) {
+    return m->data + (size_t)row * m->stride;
+}
+
+//multi-precision entries are stored as little-endian 64-bit limbs
+static inline uint64_t* coeff_limbs(const CoeffMatrix* m, int row, int col) {
+    return (uint64_t*)(coeff_row(m, row) + (size_t)col * m->elem_size);
+}
+
+static inline long long coeff_get(const CoeffMatrix* m, int row, int col) {
+    const unsigned char* r = coeff_row(m, row);
+    switch (m->elem_size) {
+        case 1: return ((const uint8_t*)r)[col];
+        case 2: return ((const uint16_t*)r)[col];
+        case 8: return ((const int64_t*)r)[col];
+        default:
+            if (m->is_signed) return ((const int32_t*)r)[col];
+            return ((const uint32_t*)r)[col];
+    }
+}
+
+static inline void coeff_set(CoeffMatrix* m, int row, int col, long long value) {
+    unsigned char* r = coeff_row(m, row);
+    switch (m->elem_size) {
+        case 1: ((uint8_t*)r)[col] = (uint8_t)value; break;
+        case 2: ((uint16_t*)r)[col] = (uint16_t)value; break;
+        case 8: ((int64_t*)r)[col] = value; break;
+        default:
+            if (m->is_signed) ((int32_t*)r)[col] = (int32_t)value;
+            else ((uint32_t*)r)[col] = (uint32_t)value;
+            break;
+    }
+}
+
+#endif
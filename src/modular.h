@@ -0,0 +1,36 @@
+#ifndef MODULAR_H
+#define MODULAR_H
+
+//arithmetic on residues in [0, m) for a word-size modulus 0 < m < 2^63; products
+//are taken in 128 bits, so every such modulus stays on this path
+
+__extension__ typedef unsigned __int128 mod_wide_t;
+
+static inline long long mod_add(long long a, long long b, long long m) {
+    return a >= m - b ? a - (m - b) : a + b;
+}
+
+static inline long long mod_sub(long long a, long long b, long long m) {
+    return a >= b ? a - b : a + (m - b);
+}
+
+static inline long long mod_mul(long long a, long long b, long long m) {
+    return (long long)((mod_wide_t)(unsigned long long)a * (unsigned long long)b % (unsigned long long)m);
+}
+
+//the inverse of a modulo m, 0 when a is not a unit
+static inline long long mod_inverse(long long a, long long m) {
+    long long old_r = a, r = m;
+    long long old_s = 1, s = 0;
+
+    while (r != 0) {
+        long long q = old_r / r;
+        long long t = old_r - q * r; old_r = r; r = t;
+        t = old_s - q * s; old_s = s; s = t;
+    }
+
+    if (old_r != 1) return 0;
+    return old_s < 0 ? old_s + m : old_s;
+}
+
+#endif
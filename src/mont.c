@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mont.h"
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 wide_t;
+
+//a*b + c + d never exceeds 128 bits
+static inline limb_t mul_add(limb_t a, limb_t b, limb_t c, limb_t d, limb_t* hi) {
+    wide_t t = (wide_t)a * b + c + d;
+    *hi = (limb_t)(t >> 64);
+    return (limb_t)t;
+}
+#else
+static inline limb_t mul_add(limb_t a, limb_t b, limb_t c, limb_t d, limb_t* hi) {
+    limb_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    limb_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+
+    limb_t p0 = a_lo * b_lo;
+    limb_t p1 = a_lo * b_hi;
+    limb_t p2 = a_hi * b_lo;
+    limb_t p3 = a_hi * b_hi;
+
+    limb_t mid = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+    limb_t lo = (p0 & 0xFFFFFFFFu) | (mid << 32);
+    limb_t high = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+
+    lo += c;
+    high += (lo < c);
+    lo += d;
+    high += (lo < d);
+
+    *hi = high;
+    return lo;
+}
+#endif
+
+static const int SPECIALIZED_LIMBS[] = {1, 2, 4, 6, 8, 16, 32, 64};
+
+static int geq(const limb_t* a, const limb_t* b, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return 1;
+}
+
+static limb_t sub_n(limb_t* out, const limb_t* a, const limb_t* b, int n) {
+    limb_t borrow = 0;
+    for (int i = 0; i < n; i++) {
+        limb_t d = a[i] - b[i];
+        limb_t next = (a[i] < b[i]) | (d < borrow);
+        out[i] = d - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static limb_t add_n(limb_t* out, const limb_t* a, const limb_t* b, int n) {
+    limb_t carry = 0;
+    for (int i = 0; i < n; i++) {
+        limb_t s = a[i] + carry;
+        limb_t c1 = (s < carry);
+        out[i] = s + b[i];
+        carry = c1 | (out[i] < s);
+    }
+    return carry;
+}
+
+//coarsely integrated operand scanning; n is a compile-time constant in the
+//specialized wrappers below so the inner loops are fixed-length
+static inline void mont_mul_cios(limb_t* out, const limb_t* a, const limb_t* b,
+                                 const MontContext* ctx, int n) {
+    limb_t t[MONT_MAX_LIMBS + 2];
+    const limb_t* p = ctx->modulus;
+    memset(t, 0, sizeof(limb_t) * (n + 2));
+
+    for (int i = 0; i < n; i++) {
+        limb_t carry = 0;
+        for (int j = 0; j < n; j++) {
+            t[j] = mul_add(a[j], b[i], t[j], carry, &carry);
+        }
+        limb_t s = t[n] + carry;
+        t[n + 1] = (s < carry);
+        t[n] = s;
+
+        limb_t m = t[0] * ctx->n0;
+        mul_add(m, p[0], t[0], 0, &carry);
+        for (int j = 1; j < n; j++) {
+            t[j - 1] = mul_add(m, p[j], t[j], carry, &carry);
+        }
+        s = t[n] + carry;
+        t[n - 1] = s;
+        t[n] = t[n + 1] + (s < carry);
+    }
+
+    if (t[n] || geq(t, p, n)) {
+        sub_n(out, t, p, n);
+    } else {
+        memcpy(out, t, sizeof(limb_t) * n);
+    }
+}
+
+#define MONT_SPECIALIZE(N) \
+    static void mont_mul_##N(limb_t* out, const limb_t* a, const limb_t* b, \
+                             const MontContext* ctx) { \
+        mont_mul_cios(out, a, b, ctx, N); \
+    }
+
+MONT_SPECIALIZE(1)
+MONT_SPECIALIZE(2)
+MONT_SPECIALIZE(4)
+MONT_SPECIALIZE(6)
+MONT_SPECIALIZE(8)
+MONT_SPECIALIZE(16)
+MONT_SPECIALIZE(32)
+MONT_SPECIALIZE(64)
+
+static MontMulFn specialized_mul(int limbs) {
+    switch (limbs) {
+        case 1: return mont_mul_1;
+        case 2: return mont_mul_2;
+        case 4: return mont_mul_4;
+        case 6: return mont_mul_6;
+        case 8: return mont_mul_8;
+        case 16: return mont_mul_16;
+        case 32: return mont_mul_32;
+        default: return mont_mul_64;
+    }
+}
+
+//x = 2x mod p for x < p
+static void double_mod(limb_t* x, const limb_t* p, int n) {
+    limb_t carry = 0;
+    for (int i = 0; i < n; i++) {
+        limb_t next = x[i] >> 63;
+        x[i] = (x[i] << 1) | carry;
+        carry = next;
+    }
+    if (carry || geq(x, p, n)) sub_n(x, x, p, n);
+}
+
+//returns 0 on success, -1 if too wide, -2 if even, -3 if not above one
+int mont_init(MontContext* ctx, const char* digits, size_t len) {
+    if (!ctx || !digits || len == 0) return -1;
+
+    limb_t value[MONT_MAX_LIMBS + 1];
+    memset(value, 0, sizeof(value));
+
+    for (size_t k = 0; k < len; k++) {
+        if (digits[k] < '0' || digits[k] > '9') return -1;
+
+        limb_t carry = (limb_t)(digits[k] - '0');
+        for (int i = 0; i <= MONT_MAX_LIMBS; i++) {
+            value[i] = mul_add(value[i], 10, carry, 0, &carry);
+        }
+        if (carry || value[MONT_MAX_LIMBS]) return -1;
+    }
+
+    return mont_init_limbs(ctx, value, MONT_MAX_LIMBS);
+}
+
+//same contract as mont_init, for a modulus already split into little-endian limbs
+int mont_init_limbs(MontContext* ctx, const limb_t* value, int count) {
+    if (!ctx || !value || count < 0) return -1;
+
+    int used = count;
+    while (used > 0 && value[used - 1] == 0) used--;
+    if (used > MONT_MAX_LIMBS) return -1;
+
+    memset(ctx, 0, sizeof(*ctx));
+    if (used == 0 || (used == 1 && value[0] <= 1)) return -3;
+    if ((value[0] & 1) == 0) return -2;
+
+    int limbs = MONT_MAX_LIMBS;
+    for (size_t i = 0; i < sizeof(SPECIALIZED_LIMBS) / sizeof(SPECIALIZED_LIMBS[0]); i++) {
+        if (SPECIALIZED_LIMBS[i] >= used) {
+            limbs = SPECIALIZED_LIMBS[i];
+            break;
+        }
+    }
+
+    ctx->limbs = limbs;
+    memcpy(ctx->modulus, value, sizeof(limb_t) * used);
+
+    int top = 63;
+    while (!((value[used - 1] >> top) & 1)) top--;
+    ctx->bits = (used - 1) * 64 + top + 1;
+
+    limb_t inv = value[0];
+    for (int i = 0; i < 5; i++) inv *= 2 - value[0] * inv;
+    ctx->n0 = (limb_t)0 - inv;
+
+    ctx->r_mod[0] = 1;
+    for (int i = 0; i < 64 * limbs; i++) double_mod(ctx->r_mod, ctx->modulus, limbs);
+
+    memcpy(ctx->r2_mod, ctx->r_mod, sizeof(limb_t) * limbs);
+    for (int i = 0; i < 64 * limbs; i++) double_mod(ctx->r2_mod, ctx->modulus, limbs);
+
+    ctx->mul = specialized_mul(limbs);
+    return 0;
+}
+
+void mont_mul(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b) {
+    ctx->mul(out, a, b, ctx);
+}
+
+void mont_add(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b) {
+    limb_t carry = add_n(out, a, b, ctx->limbs);
+    if (carry || geq(out, ctx->modulus, ctx->limbs)) sub_n(out, out, ctx->modulus, ctx->limbs);
+}
+
+void mont_sub(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b) {
+    if (sub_n(out, a, b, ctx->limbs)) add_n(out, out, ctx->modulus, ctx->limbs);
+}
+
+void mont_zero(const MontContext* ctx, limb_t* out) {
+    memset(out, 0, sizeof(limb_t) * ctx->limbs);
+}
+
+void mont_one(const MontContext* ctx, limb_t* out) {
+    memcpy(out, ctx->r_mod, sizeof(limb_t) * ctx->limbs);
+}
+
+int mont_is_zero(const MontContext* ctx, const limb_t* a) {
+    for (int i = 0; i < ctx->limbs; i++) {
+        if (a[i]) return 0;
+    }
+    return 1;
+}
+
+int mont_equal(const MontContext* ctx, const limb_t* a, const limb_t* b) {
+    return memcmp(a, b, sizeof(limb_t) * ctx->limbs) == 0;
+}
+
+//Fermat inversion, so this only succeeds when the modulus is prime
+int mont_inverse(const MontContext* ctx, limb_t* out, const limb_t* a) {
+    int n = ctx->limbs;
+    if (mont_is_zero(ctx, a)) return -1;
+
+    limb_t exponent[MONT_MAX_LIMBS];
+    limb_t two[MONT_MAX_LIMBS];
+    memset(two, 0, sizeof(limb_t) * n);
+    two[0] = 2;
+    sub_n(exponent, ctx->modulus, two, n);
+
+    limb_t result[MONT_MAX_LIMBS];
+    mont_one(ctx, result);
+
+    for (int bit = ctx->bits - 1; bit >= 0; bit--) {
+        mont_mul(ctx, result, result, result);
+        if ((exponent[bit / 64] >> (bit % 64)) & 1) {
+            mont_mul(ctx, result, result, a);
+        }
+    }
+
+    limb_t check[MONT_MAX_LIMBS];
+    mont_mul(ctx, check, result, a);
+    if (memcmp(check, ctx->r_mod, sizeof(limb_t) * n) != 0) return -1;
+
+    memcpy(out, result, sizeof(limb_t) * n);
+    return 0;
+}
+
+void mont_from_int(const MontContext* ctx, limb_t* out, long long value) {
+    limb_t plain[MONT_MAX_LIMBS];
+    memset(plain, 0, sizeof(limb_t) * ctx->limbs);
+
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value
+                                             : (unsigned long long)value;
+    plain[0] = magnitude;
+
+    mont_mul(ctx, out, plain, ctx->r2_mod);
+    if (value < 0) {
+        limb_t zero[MONT_MAX_LIMBS];
+        mont_zero(ctx, zero);
+        mont_sub(ctx, out, zero, out);
+    }
+}
+
+void mont_from_decimal(const MontContext* ctx, limb_t* out, const char* digits, size_t len) {
+    limb_t scale[MONT_MAX_LIMBS];
+    limb_t chunk[MONT_MAX_LIMBS];
+    mont_from_int(ctx, scale, 1000000000000000000LL);
+    mont_zero(ctx, out);
+
+    //consume 18 digits at a time, the leading chunk takes the remainder
+    size_t pos = 0;
+    size_t first = len % 18 ? len % 18 : 18;
+    while (pos < len) {
+        size_t take = pos == 0 ? first : 18;
+        long long part = 0;
+        for (size_t k = 0; k < take; k++) part = part * 10 + (digits[pos + k] - '0');
+
+        if (pos > 0) mont_mul(ctx, out, out, scale);
+        mont_from_int(ctx, chunk, part);
+        mont_add(ctx, out, out, chunk);
+        pos += take;
+    }
+}
+
+//integers past a word go through their decimal digits
+void mont_from_value(const MontContext* ctx, limb_t* out, Value value) {
+    long long small;
+    if (value_to_long(value, &small) == 0) {
+        mont_from_int(ctx, out, small);
+        return;
+    }
+
+    char* text = value_to_string(value);
+    int negative = text[0] == '-';
+    mont_from_decimal(ctx, out, text + negative, strlen(text + negative));
+    free(text);
+    if (negative) {
+        limb_t zero[MONT_MAX_LIMBS];
+        mont_zero(ctx, zero);
+        mont_sub(ctx, out, zero, out);
+    }
+}
+
+int mont_to_decimal(const MontContext* ctx, const limb_t* a, char* buf, size_t size) {
+    int n = ctx->limbs;
+
+    limb_t one[MONT_MAX_LIMBS];
+    limb_t plain[MONT_MAX_LIMBS];
+    memset(one, 0, sizeof(limb_t) * n);
+    one[0] = 1;
+    mont_mul(ctx, plain, a, one);
+
+    //peel off base 10^9 chunks using 32-bit halves so no wide division is needed
+    char reversed[MONT_MAX_LIMBS * 20 + 2];
+    size_t count = 0;
+    int used = n;
+    while (used > 0 && plain[used - 1] == 0) used--;
+
+    while (used > 0) {
+        limb_t rem = 0;
+        for (int i = used - 1; i >= 0; i--) {
+            limb_t high = (rem << 32) | (plain[i] >> 32);
+            limb_t q_high = high / 1000000000u;
+            rem = high % 1000000000u;
+            limb_t low = (rem << 32) | (plain[i] & 0xFFFFFFFFu);
+            limb_t q_low = low / 1000000000u;
+            rem = low % 1000000000u;
+            plain[i] = (q_high << 32) | q_low;
+        }
+        while (used > 0 && plain[used - 1] == 0) used--;
+
+        for (int d = 0; d < 9 && (used > 0 || rem > 0 || d == 0); d++) {
+            reversed[count++] = (char)('0' + rem % 10);
+            rem /= 10;
+        }
+    }
+    if (count == 0) reversed[count++] = '0';
+
+    if (count + 1 > size) return -1;
+    for (size_t i = 0; i < count; i++) buf[i] = reversed[count - 1 - i];
+    buf[count] = '\0';
+    return 0;
+}
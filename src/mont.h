@@ -0,0 +1,45 @@
+#ifndef MONT_H
+#define MONT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "value.h"
+
+#define MONT_MAX_LIMBS 64
+
+typedef uint64_t limb_t;
+
+struct MontContext;
+typedef void (*MontMulFn)(limb_t* out, const limb_t* a, const limb_t* b,
+                          const struct MontContext* ctx);
+
+//odd modulus with R = 2^(64*limbs); limbs is rounded up to a specialized width
+typedef struct MontContext {
+    int limbs;
+    int bits;
+    limb_t modulus[MONT_MAX_LIMBS];
+    limb_t n0;
+    limb_t r_mod[MONT_MAX_LIMBS];
+    limb_t r2_mod[MONT_MAX_LIMBS];
+    MontMulFn mul;
+} MontContext;
+
+int mont_init(MontContext* ctx, const char* digits, size_t len);
+int mont_init_limbs(MontContext* ctx, const limb_t* modulus, int count);
+
+void mont_mul(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b);
+void mont_add(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b);
+void mont_sub(const MontContext* ctx, limb_t* out, const limb_t* a, const limb_t* b);
+int mont_inverse(const MontContext* ctx, limb_t* out, const limb_t* a);
+
+void mont_zero(const MontContext* ctx, limb_t* out);
+void mont_one(const MontContext* ctx, limb_t* out);
+int mont_is_zero(const MontContext* ctx, const limb_t* a);
+int mont_equal(const MontContext* ctx, const limb_t* a, const limb_t* b);
+
+void mont_from_decimal(const MontContext* ctx, limb_t* out, const char* digits, size_t len);
+void mont_from_int(const MontContext* ctx, limb_t* out, long long value);
+void mont_from_value(const MontContext* ctx, limb_t* out, Value value);
+int mont_to_decimal(const MontContext* ctx, const limb_t* a, char* buf, size_t size);
+
+#endif
@@ -2,7 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
 #include "parser.h"
+#include "fixpoint.h"
+#include "check.h"
+#include "fault.h"
+#include "store.h"
+#include "modular.h"
 
 
 void safe_strcpy(char* dest, const char* src, size_t dest_size) {
@@ -11,7 +18,7 @@ void safe_strcpy(char* dest, const char* src, size_t dest_size) {
     size_t src_len = strlen(src);
     size_t copy_len = (src_len < dest_size - 1) ? src_len : dest_size - 1;
 
-    strncpy(dest, src, copy_len);
+    memcpy(dest, src, copy_len);
     dest[copy_len] = '\0';
 }
 
@@ -20,35 +27,158 @@ Parser* parser_create(void) {
     Parser* parser = malloc(sizeof(Parser));
     if (!parser) return NULL;
 
+    parser->source = NULL;
+    parser->out = stdout;
     parser->pos = 0;
     parser->size = 0;
     parser->ring_count = 0;
     parser->module_count = 0;
-
+    parser->relation_count = 0;
+    parser->relation_block_count = 0;
+    parser->definition_count = 0;
+    parser->profiler = NULL;
+    parser->fast_check = NULL;
+    parser->store = NULL;
+    parser->pending = NULL;
+
+    parser->exprs = expr_pool_create();
+    if (!parser->exprs) {
+        free(parser);
+        return NULL;
+    }
 
     memset(parser->rings, 0, sizeof(parser->rings));
     memset(parser->modules, 0, sizeof(parser->modules));
+    memset(parser->definitions, 0, sizeof(parser->definitions));
     memset(parser->tokens, 0, sizeof(parser->tokens));
 
     return parser;
 }
 
+//forgets the rings, modules and definitions declared after the given counts
+void parser_truncate(Parser* p, int ring_count, int module_count, int definition_count) {
+    if (!p) return;
+
+    for (int i = definition_count; i < p->definition_count && i < MAX_DEFINITIONS; i++) {
+        if (p->definitions[i].evaluated) rt_value_release(&p->definitions[i].value);
+        memset(&p->definitions[i], 0, sizeof(p->definitions[i]));
+    }
+    if (p->definition_count > definition_count) p->definition_count = definition_count;
+
+    for (int i = ring_count; i < p->ring_count && i < MAX_RINGS; i++) {
+        free(p->rings[i].mont);
+        memset(&p->rings[i], 0, sizeof(p->rings[i]));
+    }
+
+    for (int i = module_count; i < p->module_count && i < MAX_MODULES; i++) {
+        free(p->modules[i].generators);
+        coeff_matrix_free(&p->modules[i].coeffs);
+        echelon_free(&p->modules[i].relations);
+        int_matrix_free(&p->modules[i].presentation);
+        memset(&p->modules[i], 0, sizeof(p->modules[i]));
+    }
+
+    if (p->ring_count > ring_count) p->ring_count = ring_count;
+    if (p->module_count > module_count) p->module_count = module_count;
+}
+
 void parser_destroy(Parser* p) {
     if (!p) return;
 
+    parser_truncate(p, 0, 0, 0);
 
-    for (int i = 0; i < p->module_count && i < MAX_MODULES; i++) {
-        if (p->modules[i].generators) {
-            for (int j = 0; j < p->modules[i].generator_count && j < p->modules[i].dimension; j++) {
-                if (p->modules[i].generators[j]) {
-                    free(p->modules[i].generators[j]);
-                }
-            }
-            free(p->modules[i].generators);
+    free(p->pending);
+    expr_pool_destroy(p->exprs);
+    free(p);
+}
+
+//fatal: whatever this parser has reported so far is flushed ahead of the message,
+//unless a library call installed a recovery point for it
+void parser_error(Parser* p, const char* fmt, ...) {
+    if (fault_active()) {
+        char message[FAULT_MESSAGE_LEN];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(message, sizeof(message), fmt, args);
+        va_end(args);
+        fault_raise(p ? current_token(p).offset : -1, message);
+    }
+
+    flockfile(stdout);
+    if (p && p->out && p->out != stdout) {
+        fflush(p->out);
+        rewind(p->out);
+
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), p->out)) > 0) {
+            fwrite(buffer, 1, n, stdout);
         }
     }
 
-    free(p);
+    va_list args;
+    va_start(args, fmt);
+    printf("Error: ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+    funlockfile(stdout);
+
+    exit(1);
+}
+
+Ring* parser_add_ring(Parser* p, const char* name, int is_finite_field, long long modulus,
+                      const MontContext* mont) {
+    if (p->ring_count >= MAX_RINGS) {
+        parser_error(p, "Too many rings defined (max %d)", MAX_RINGS);
+    }
+
+    Ring* ring = &p->rings[p->ring_count];
+    memset(ring, 0, sizeof(*ring));
+    if (mont) {
+        ring->mont = malloc(sizeof(MontContext));
+        if (!ring->mont) {
+            parser_error(p, "Memory allocation failed for modulus");
+        }
+        *ring->mont = *mont;
+    }
+
+    safe_strcpy(ring->name, name, sizeof(ring->name));
+    ring->is_finite_field = is_finite_field;
+    ring->modulus = mont ? 0 : modulus;
+    p->ring_count++;
+    return ring;
+}
+
+Module* parser_add_module(Parser* p, const char* name, Ring* ring, int dimension) {
+    if (p->module_count >= MAX_MODULES) {
+        parser_error(p, "Too many modules defined (max %d)", MAX_MODULES);
+    }
+
+    Module* module = &p->modules[p->module_count];
+    memset(module, 0, sizeof(*module));
+    safe_strcpy(module->name, name, sizeof(module->name));
+    module->base_ring = ring;
+    module->dimension = dimension;
+    module->generators = calloc(dimension, sizeof(*module->generators));
+
+    int width = ring->mont ? ring->mont->limbs * (int)sizeof(limb_t)
+                           : coeff_width_for_modulus(ring->modulus);
+    if (!module->generators ||
+        coeff_matrix_init(&module->coeffs, dimension, dimension, width, !ring->is_finite_field) != 0 ||
+        echelon_init(&module->relations, dimension, ring->modulus, ring->mont) != 0 ||
+        int_matrix_init(&module->presentation, dimension) != 0) {
+        //whichever parts were allocated before the failure; the others are still zeroed
+        free(module->generators);
+        coeff_matrix_free(&module->coeffs);
+        echelon_free(&module->relations);
+        int_matrix_free(&module->presentation);
+        memset(module, 0, sizeof(*module));
+        parser_error(p, "Memory allocation failed for module generators");
+    }
+
+    p->module_count++;
+    return module;
 }
 
 char* read_file(const char* filename) {
@@ -93,7 +223,7 @@ char* read_file(const char* filename) {
 
 Token current_token(Parser* p) {
     if (!p || p->pos < 0 || p->pos >= p->size) {
-        Token eof = {TOKEN_EOF, ""};
+        Token eof = {TOKEN_EOF, "", 0, 0};
         return eof;
     }
     return p->tokens[p->pos];
@@ -101,7 +231,7 @@ Token current_token(Parser* p) {
 
 Token next_token(Parser* p) {
     if (!p || p->pos < 0) {
-        Token eof = {TOKEN_EOF, ""};
+        Token eof = {TOKEN_EOF, "", 0, 0};
         return eof;
     }
 
@@ -121,17 +251,33 @@ int match(Parser* p, TokenType type) {
 
 void expect(Parser* p, TokenType type, const char* msg) {
     if (!p) {
-        printf("Error: Parser is NULL\n");
-        exit(1);
+        parser_error(NULL, "Parser is NULL");
     }
 
     if (!match(p, type)) {
-        printf("Error: Expected %s but got '%s' (type: %d)\n",
-               msg, current_token(p).value, current_token(p).type);
-        exit(1);
+        parser_error(p, "Expected %s but got '%s' (type: %d)",
+                     msg, current_token(p).value, current_token(p).type);
     }
 }
 
+//full digits of a number token, which may be longer than the token buffer
+static const char* number_text(Parser* p, int index, size_t* len) {
+    const Token* tok = &p->tokens[index];
+    const char* digits = tok->value;
+    *len = strlen(tok->value);
+
+    if (p->source && tok->length > 0) {
+        digits = p->source + tok->offset;
+        *len = (size_t)tok->length;
+    }
+
+    while (*len > 1 && digits[0] == '0') {
+        digits++;
+        (*len)--;
+    }
+    return digits;
+}
+
 Ring* find_ring(Parser* p, const char* name) {
     if (!p || !name) return NULL;
 
@@ -167,39 +313,49 @@ void parse_ring_declaration(Parser* p) {
 
     if (match(p, TOKEN_INTEGERS_MOD)) {
         expect(p, TOKEN_NUMBER, "modulus");
-        int modulus = atoi(p->tokens[p->pos-1].value);
+        size_t len;
+        const char* digits = number_text(p, p->pos-1, &len);
+
+        //moduli that fit a signed word stay on 64-bit arithmetic, larger ones switch
+        //to multi-precision Montgomery arithmetic
+        long long modulus = 0;
+        int big = 0;
+        for (size_t i = 0; i < len && !big; i++) {
+            int d = digits[i] - '0';
+            if (modulus > (LLONG_MAX - d) / 10) big = 1;
+            else modulus = modulus * 10 + d;
+        }
 
-        if (modulus <= 0) {
-            printf("Error: Invalid modulus %d, must be positive\n", modulus);
-            exit(1);
+        if (!big && modulus <= 0) {
+            parser_error(p, "Invalid modulus %lld, must be positive", modulus);
         }
 
-        if (p->ring_count >= MAX_RINGS) {
-            printf("Error: Too many rings defined (max %d)\n", MAX_RINGS);
-            exit(1);
+        MontContext mont;
+        if (big) {
+            int status = mont_init(&mont, digits, len);
+            if (status == -2) parser_error(p, "Multi-precision modulus must be odd");
+            if (status != 0) parser_error(p, "Modulus exceeds %d bits", MONT_MAX_LIMBS * 64);
         }
 
-        Ring* ring = &p->rings[p->ring_count++];
-        safe_strcpy(ring->name, ring_name, sizeof(ring->name));
-        ring->is_finite_field = 1;
-        ring->modulus = modulus;
+        Ring* ring = parser_add_ring(p, ring_name, 1, big ? 0 : modulus, big ? &mont : NULL);
 
-        printf("Defined finite field: %s = Z/%dZ\n", ring_name, modulus);
-    } else if (match(p, TOKEN_RATIONALS)) {
-        if (p->ring_count >= MAX_RINGS) {
-            printf("Error: Too many rings defined (max %d)\n", MAX_RINGS);
-            exit(1);
+        if (big) {
+            fprintf(p->out, "Defined finite field: %s = Z/%.*sZ (%d-bit modulus)\n",
+                    ring_name, (int)len, digits, mont.bits);
+        } else {
+            fprintf(p->out, "Defined finite field: %s = Z/%lldZ\n", ring_name, ring->modulus);
         }
+    } else if (match(p, TOKEN_RATIONALS)) {
+        parser_add_ring(p, ring_name, 0, 0, NULL);
 
-        Ring* ring = &p->rings[p->ring_count++];
-        safe_strcpy(ring->name, ring_name, sizeof(ring->name));
-        ring->is_finite_field = 0;
-        ring->modulus = 0;
+        fprintf(p->out, "Defined ring: %s = Q\n", ring_name);
+    } else if (match(p, TOKEN_INTEGERS)) {
+        Ring* ring = parser_add_ring(p, ring_name, 0, 0, NULL);
+        ring->is_integer = 1;
 
-        printf("Defined ring: %s = Q\n", ring_name);
+        fprintf(p->out, "Defined ring: %s = Z\n", ring_name);
     } else {
-        printf("Error: Expected ring type (integers_mod or rationals)\n");
-        exit(1);
+        parser_error(p, "Expected ring type (integers_mod, rationals or integers)");
     }
 }
 
@@ -223,8 +379,7 @@ void parse_module_declaration(Parser* p) {
 
     Ring* ring = find_ring(p, ring_name);
     if (!ring) {
-        printf("Error: Unknown ring '%s'\n", ring_name);
-        exit(1);
+        parser_error(p, "Unknown ring '%s'", ring_name);
     }
 
     expect(p, TOKEN_COMMA, "','");
@@ -232,30 +387,47 @@ void parse_module_declaration(Parser* p) {
     int dimension = atoi(p->tokens[p->pos-1].value);
 
     if (dimension <= 0) {
-        printf("Error: Invalid dimension %d, must be positive\n", dimension);
-        exit(1);
+        parser_error(p, "Invalid dimension %d, must be positive", dimension);
     }
 
     expect(p, TOKEN_RPAREN, "')'");
 
-    if (p->module_count >= MAX_MODULES) {
-        printf("Error: Too many modules defined (max %d)\n", MAX_MODULES);
-        exit(1);
-    }
+    parser_add_module(p, module_name, ring, dimension);
 
-    Module* module = &p->modules[p->module_count++];
-    safe_strcpy(module->name, module_name, sizeof(module->name));
-    module->base_ring = ring;
-    module->dimension = dimension;
-    module->generator_count = 0;
-    module->generators = calloc(dimension, sizeof(char*));
+    fprintf(p->out, "Defined module: %s = %s^%d\n", module_name, ring_name, dimension);
+}
 
-    if (!module->generators) {
-        printf("Error: Memory allocation failed for module generators\n");
-        exit(1);
+typedef struct {
+    int token;
+    int negative;
+} GeneratorCoord;
+
+static long long reduce_coefficient(const char* digits, int negative, const Ring* ring, int* ok) {
+    *ok = 1;
+
+    if (ring->is_finite_field) {
+        long long m = ring->modulus;
+        long long value = 0;
+        for (const char* d = digits; *d; d++) {
+            value = mod_add(mod_mul(value, 10 % m, m), (*d - '0') % m, m);
+        }
+        return (negative && value) ? m - value : value;
     }
 
-    printf("Defined module: %s = %s^%d\n", module_name, ring_name, dimension);
+    long long value = 0;
+    for (const char* d = digits; *d; d++) {
+        value = value * 10 + (*d - '0');
+        if (value > 2147483648LL) {
+            *ok = 0;
+            return 0;
+        }
+    }
+    if (negative) value = -value;
+    if (value > 2147483647LL) {
+        *ok = 0;
+        return 0;
+    }
+    return value;
 }
 
 void parse_generators(Parser* p) {
@@ -264,6 +436,13 @@ void parse_generators(Parser* p) {
     expect(p, TOKEN_GENERATORS, "'generators'");
     expect(p, TOKEN_LBRACE, "'{'");
 
+    int coord_capacity = 16;
+    GeneratorCoord* coords = malloc(sizeof(GeneratorCoord) * coord_capacity);
+    if (!coords) {
+        parser_error(p, "Memory allocation failed for generator coordinates");
+    }
+    p->pending = coords;
+
     while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
         expect(p, TOKEN_IDENTIFIER, "generator name");
         char gen_name[MAX_IDENTIFIER_LEN + 2];
@@ -272,23 +451,44 @@ void parse_generators(Parser* p) {
         expect(p, TOKEN_EQUALS, "'='");
         expect(p, TOKEN_LPAREN, "'('");
 
-        printf("  Generator: %s = (", gen_name);
-
+        fprintf(p->out, "  Generator: %s = (", gen_name);
 
+        //coordinates are reduced once the module, and so the ring, is known
+        int coord_count = 0;
         int first = 1;
         while (current_token(p).type != TOKEN_RPAREN && current_token(p).type != TOKEN_EOF) {
+            int negative = 0;
+            if (current_token(p).type == TOKEN_MINUS && p->pos + 1 < p->size &&
+                p->tokens[p->pos+1].type == TOKEN_NUMBER) {
+                negative = 1;
+                next_token(p);
+            }
+
             if (match(p, TOKEN_NUMBER)) {
-                if (!first) printf(", ");
-                printf("%s", p->tokens[p->pos-1].value);
+                if (!first) fprintf(p->out, ", ");
+                fprintf(p->out, "%s%s", negative ? "-" : "", p->tokens[p->pos-1].value);
                 first = 0;
+
+                if (coord_count == coord_capacity) {
+                    coord_capacity *= 2;
+                    GeneratorCoord* grown = realloc(coords, sizeof(GeneratorCoord) * coord_capacity);
+                    if (!grown) {
+                        parser_error(p, "Memory allocation failed for generator coordinates");
+                    }
+                    coords = grown;
+                    p->pending = coords;
+                }
+                coords[coord_count].token = p->pos-1;
+                coords[coord_count].negative = negative;
+                coord_count++;
             } else if (match(p, TOKEN_COMMA)) {
 
             } else {
-                printf(" [unexpected: %s]", current_token(p).value);
+                fprintf(p->out, " [unexpected: %s]", current_token(p).value);
                 next_token(p);
             }
         }
-        printf(")");
+        fprintf(p->out, ")");
 
         expect(p, TOKEN_RPAREN, "')'");
         expect(p, TOKEN_IN, "'in'");
@@ -300,19 +500,45 @@ void parse_generators(Parser* p) {
 
         if (module) {
             if (module->generator_count < module->dimension) {
-                module->generators[module->generator_count] = malloc(MAX_IDENTIFIER_LEN + 2);
-                if (!module->generators[module->generator_count]) {
-                    printf(" [ERROR: Memory allocation failed]");
-                } else {
-                    safe_strcpy(module->generators[module->generator_count], gen_name, MAX_IDENTIFIER_LEN + 2);
-                    module->generator_count++;
-                    printf(" in %s\n", module_name);
+                int row = module->generator_count++;
+                safe_strcpy(module->generators[row], gen_name, sizeof(module->generators[row]));
+
+                int range_ok = 1;
+                for (int i = 0; i < coord_count && i < module->dimension; i++) {
+                    const MontContext* mont = module->base_ring->mont;
+                    if (mont) {
+                        size_t len;
+                        const char* digits = number_text(p, coords[i].token, &len);
+                        limb_t* entry = coeff_limbs(&module->coeffs, row, i);
+                        mont_from_decimal(mont, entry, digits, len);
+                        if (coords[i].negative) {
+                            limb_t zero[MONT_MAX_LIMBS];
+                            mont_zero(mont, zero);
+                            mont_sub(mont, entry, zero, entry);
+                        }
+                        continue;
+                    }
+
+                    int ok;
+                    long long value = reduce_coefficient(p->tokens[coords[i].token].value,
+                                                         coords[i].negative, module->base_ring, &ok);
+                    if (!ok) range_ok = 0;
+                    coeff_set(&module->coeffs, row, i, value);
                 }
+
+                fprintf(p->out, " in %s", module_name);
+                if (coord_count != module->dimension) {
+                    fprintf(p->out, " [WARNING: expected %d coordinates, got %d]", module->dimension, coord_count);
+                }
+                if (!range_ok) {
+                    fprintf(p->out, " [WARNING: coefficient out of range, stored as 0]");
+                }
+                fprintf(p->out, "\n");
             } else {
-                printf(" [ERROR: Module %s is full (dimension %d)]\n", module_name, module->dimension);
+                fprintf(p->out, " [ERROR: Module %s is full (dimension %d)]\n", module_name, module->dimension);
             }
         } else {
-            printf(" [ERROR: Module %s not found]\n", module_name);
+            fprintf(p->out, " [ERROR: Module %s not found]\n", module_name);
         }
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
@@ -320,56 +546,335 @@ void parse_generators(Parser* p) {
         }
     }
 
+    p->pending = NULL;
+    free(coords);
     expect(p, TOKEN_RBRACE, "'}'");
 }
 
-void parse_relations(Parser* p) {
+//the unit driver has already compiled the file and copied its structures in
+void parse_import(Parser* p) {
     if (!p) return;
 
-    expect(p, TOKEN_RELATIONS, "'relations'");
-    expect(p, TOKEN_LBRACE, "'{'");
+    expect(p, TOKEN_IMPORT, "'import'");
+    expect(p, TOKEN_STRING, "file name");
+    fprintf(p->out, "Imported: %s\n", p->tokens[p->pos-1].value);
 
-    int relation_count = 0;
+    if (current_token(p).type == TOKEN_SEMICOLON) {
+        match(p, TOKEN_SEMICOLON);
+    }
+}
 
-    while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
-        printf("  Relation %d: ", ++relation_count);
+static Module* find_generator(Parser* p, const char* name, int* index) {
+    for (int i = 0; i < p->module_count; i++) {
+        Module* module = &p->modules[i];
+        for (int g = 0; g < module->generator_count; g++) {
+            if (strcmp(module->generators[g], name) == 0) {
+                *index = g;
+                return module;
+            }
+        }
+    }
+    return NULL;
+}
 
-        int brace_count = 0;
-        int paren_count = 0;
-        int bracket_count = 0;
+//the one module a linear relation is over, or NULL when it is not solved; the reason
+//is reported to out unless that is NULL
+static Module* relation_module(Parser* p, const LinearForm* form, FILE* out) {
+    if (!form || form->term_count == 0) return NULL;
+
+    Module* module = NULL;
+    int index;
+    for (int i = 0; i < form->term_count; i++) {
+        Module* owner = find_generator(p, form->terms[i].var, &index);
+        if (!owner) return NULL;
+        if (module && owner != module) {
+            if (out) {
+                fprintf(out, "Warning: Relation mixes generators of %s and %s, not solved\n",
+                        module->name, owner->name);
+            }
+            return NULL;
+        }
+        module = owner;
+    }
 
-        while ((current_token(p).type != TOKEN_SEMICOLON || brace_count > 0 || paren_count > 0 || bracket_count > 0) &&
-               current_token(p).type != TOKEN_RBRACE &&
-               current_token(p).type != TOKEN_EOF) {
+    if (value_sign(form->constant) != 0) {
+        if (out) fprintf(out, "Warning: Relation has a constant term, not added to %s\n", module->name);
+        return NULL;
+    }
 
-            if (current_token(p).type == TOKEN_LBRACE) brace_count++;
-            if (current_token(p).type == TOKEN_RBRACE) brace_count--;
-            if (current_token(p).type == TOKEN_LPAREN) paren_count++;
-            if (current_token(p).type == TOKEN_RPAREN) paren_count--;
-            if (current_token(p).type == TOKEN_LBRACKET) bracket_count++;
-            if (current_token(p).type == TOKEN_RBRACKET) bracket_count--;
+    //the presentation over Z holds word-size integers
+    if (module->base_ring->is_integer) {
+        for (int i = 0; i < form->term_count; i++) {
+            long long c;
+            if (value_to_long(form->terms[i].coeff, &c) != 0) {
+                if (out) {
+                    fprintf(out, "Warning: Relation coefficient of %s does not fit in 64 bits, not solved\n",
+                            form->terms[i].var);
+                }
+                return NULL;
+            }
+        }
+    }
+    return module;
+}
 
+//the coefficients of a relation over module, borrowed from its form
+static void relation_row(Parser* p, const LinearForm* form, const Module* module, Value* row) {
+    for (int g = 0; g < module->dimension; g++) row[g] = value_from_fixnum(0);
+    for (int i = 0; i < form->term_count; i++) {
+        int index = -1;
+        if (find_generator(p, form->terms[i].var, &index) != module) continue;
+        row[index] = form->terms[i].coeff;
+    }
+}
 
-            if (brace_count < 0 || paren_count < 0 || bracket_count < 0) {
-                printf(" [ERROR: Unbalanced brackets]");
-                break;
+//one relation of a block, read ahead of echoing it
+typedef struct {
+    Expr* relation;
+    const LinearForm* form;
+    int end;
+    int module;
+    int status;
+} BlockRelation;
+
+//a cached entry is the status of each of the module's relations, then its echelon form
+static int restore_relations(Module* module, BlockRelation* block, int count, int index,
+                             const char* entry, size_t len) {
+    size_t rows = 0;
+    for (int i = 0; i < count; i++) {
+        if (block[i].module == index) rows++;
+    }
+    if (len < rows) return -1;
+    for (size_t r = 0; r < rows; r++) {
+        if (entry[r] < -1 || entry[r] > 1) return -1;
+    }
+    if (echelon_decode(&module->relations, (const unsigned char*)entry + rows, len - rows) != 0) {
+        return -1;
+    }
+
+    for (int i = 0, r = 0; i < count; i++) {
+        if (block[i].module == index) block[i].status = entry[r++];
+    }
+    return 0;
+}
+
+static void save_relations(Parser* p, Module* module, BlockRelation* block, int count, int index,
+                           StoreKey key) {
+    size_t rows = 0;
+    for (int i = 0; i < count; i++) {
+        if (block[i].module == index) rows++;
+    }
+
+    size_t len;
+    unsigned char* echelon = echelon_encode(&module->relations, &len);
+    char* entry = echelon ? malloc(rows + len) : NULL;
+    if (entry) {
+        for (int i = 0, r = 0; i < count; i++) {
+            if (block[i].module == index) entry[r++] = (char)(block[i].status > 0 ? 1 : block[i].status < 0 ? -1 : 0);
+        }
+        memcpy(entry + rows, echelon, len);
+        result_store_save(p->store, key, entry, rows + len);
+    }
+    free(entry);
+    free(echelon);
+}
+
+//folds a block's relations over one module into it, in order; over a field the same
+//relations added to the same echelon form are taken from the result store when it has them
+static void solve_module(Parser* p, Module* module, BlockRelation* block, int count, Value* row,
+                         long long* ints) {
+    int index = (int)(module - p->modules);
+
+    //over Z the cokernel is classified once all relations are in; relation_module
+    //only gives Z the relations whose coefficients fit in a word
+    if (module->base_ring->is_integer) {
+        for (int i = 0; i < count; i++) {
+            if (block[i].module != index) continue;
+            relation_row(p, block[i].form, module, row);
+            for (int g = 0; g < module->dimension; g++) {
+                if (value_to_long(row[g], &ints[g]) != 0) ints[g] = 0;
+            }
+            if (int_matrix_append(&module->presentation, ints) != 0) {
+                parser_error(p, "Memory allocation failed for relation coefficients");
+            }
+        }
+        return;
+    }
+
+    StoreKey key = relations_store_key(module);
+    for (int i = 0; i < count; i++) {
+        if (block[i].module != index) continue;
+        relation_row(p, block[i].form, module, row);
+        relations_store_key_add(&key, module, row);
+    }
+
+    size_t len;
+    char* entry = p->store ? result_store_load(p->store, key, &len) : NULL;
+    int hit = entry && restore_relations(module, block, count, index, entry, len) == 0;
+    free(entry);
+    if (hit) return;
+
+    for (int i = 0; i < count; i++) {
+        if (block[i].module != index) continue;
+        relation_row(p, block[i].form, module, row);
+        block[i].status = echelon_add(&module->relations, row);
+    }
+    if (p->store) save_relations(p, module, block, count, index, key);
+}
+
+//an unparsable relation is passed over up to its semicolon, echoed to out unless that is NULL
+static void skip_relation(Parser* p, FILE* out) {
+    int brace_count = 0;
+    int paren_count = 0;
+    int bracket_count = 0;
+
+    while ((current_token(p).type != TOKEN_SEMICOLON || brace_count > 0 || paren_count > 0 || bracket_count > 0) &&
+           current_token(p).type != TOKEN_RBRACE &&
+           current_token(p).type != TOKEN_EOF) {
+
+        if (current_token(p).type == TOKEN_LBRACE) brace_count++;
+        if (current_token(p).type == TOKEN_RBRACE) brace_count--;
+        if (current_token(p).type == TOKEN_LPAREN) paren_count++;
+        if (current_token(p).type == TOKEN_RPAREN) paren_count--;
+        if (current_token(p).type == TOKEN_LBRACKET) bracket_count++;
+        if (current_token(p).type == TOKEN_RBRACKET) bracket_count--;
+
+
+        if (brace_count < 0 || paren_count < 0 || bracket_count < 0) {
+            if (out) fprintf(out, " [ERROR: Unbalanced brackets]");
+            break;
+        }
+
+        if (out) fprintf(out, "%s ", current_token(p).value);
+        next_token(p);
+    }
+}
+
+//reads a whole block ahead of echoing it, so that each module's share of the relations
+//can be looked up as one before any elimination; returns how many were read
+static int solve_relations(Parser* p, BlockRelation* block) {
+    int count = 0;
+    int dimension = 0;
+
+    while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF &&
+           count <= MAX_BLOCK_RELATIONS) {
+        BlockRelation* r = &block[count++];
+        r->end = p->pos;
+        r->relation = expr_parse(p->exprs, p->tokens, &r->end, p->size);
+        r->form = NULL;
+        r->module = -1;
+        r->status = 1;
+
+        if (r->relation) {
+            p->pos = r->end;
+            r->form = expr_normalize(p->exprs, r->relation);
+            Module* module = relation_module(p, r->form, NULL);
+            if (module) {
+                r->module = (int)(module - p->modules);
+                if (module->dimension > dimension) dimension = module->dimension;
             }
+        } else {
+            skip_relation(p, NULL);
+        }
 
-            printf("%s ", current_token(p).value);
-            next_token(p);
+        if (current_token(p).type == TOKEN_SEMICOLON) {
+            match(p, TOKEN_SEMICOLON);
+        }
+    }
+
+    if (dimension == 0) return count;
+
+    //the row and its word-size copy for Z share one block
+    Value* row = malloc((sizeof(Value) + sizeof(long long)) * dimension);
+    if (!row) {
+        parser_error(p, "Memory allocation failed for relation coefficients");
+    }
+    long long* ints = (long long*)(row + dimension);
+    p->pending = row;
+
+    //elimination is timed apart from the relations, which are entered as they are echoed
+    profile_enter(p->profiler, "solve");
+
+    for (int m = 0; m < p->module_count; m++) {
+        for (int i = 0; i < count; i++) {
+            if (block[i].module != m) continue;
+            solve_module(p, &p->modules[m], block, count, row, ints);
+            break;
         }
-        printf("\n");
+    }
+    profile_leave(p->profiler);
+
+    p->pending = NULL;
+    free(row);
+    return count;
+}
+
+static void report_relation(Parser* p, const BlockRelation* r) {
+    if (r->module < 0) {
+        relation_module(p, r->form, p->out);
+        return;
+    }
+
+    const Module* module = &p->modules[r->module];
+    if (r->status == 0) {
+        fprintf(p->out, "  => implied by earlier relations\n");
+    } else if (r->status < 0) {
+        fprintf(p->out, "Warning: Relation has no invertible coefficient over %s, not added\n",
+                module->base_ring->name);
+    }
+}
+
+void parse_relations(Parser* p) {
+    if (!p) return;
+
+    expect(p, TOKEN_RELATIONS, "'relations'");
+    expect(p, TOKEN_LBRACE, "'{'");
+
+    int relation_count = 0;
+
+    //relations are numbered per block, as printed, under an entry for the block itself
+    profile_enter_index(p->profiler, "relations", ++p->relation_block_count);
+
+    //solved first, then echoed along with what solving them found
+    BlockRelation block[MAX_BLOCK_RELATIONS + 1];
+    int start = p->pos;
+    int count = p->fast_check ? 0 : solve_relations(p, block);
+    p->pos = start;
+
+    while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
+        fprintf(p->out, "  Relation %d: ", ++relation_count);
+        profile_enter_index(p->profiler, "relation", relation_count);
+
+        const BlockRelation* solved = relation_count <= count ? &block[relation_count - 1] : NULL;
+        int end = p->pos;
+        Expr* relation = solved ? solved->relation : expr_parse(p->exprs, p->tokens, &end, p->size);
+        if (solved) end = solved->end;
+
+        if (relation) {
+            while (p->pos < end) {
+                fprintf(p->out, "%s ", current_token(p).value);
+                p->pos++;
+            }
+            p->relation_count++;
+        } else {
+            skip_relation(p, p->out);
+        }
+        fprintf(p->out, "\n");
+        if (p->fast_check) fast_check_relation(p->fast_check, p, relation);
+        else if (solved) report_relation(p, solved);
+        profile_leave(p->profiler);
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
             match(p, TOKEN_SEMICOLON);
         }
 
 
-        if (relation_count > 1000) {
-            printf("Warning: Too many relations, stopping at 1000\n");
+        if (relation_count > MAX_BLOCK_RELATIONS) {
+            fprintf(p->out, "Warning: Too many relations, stopping at %d\n", MAX_BLOCK_RELATIONS);
             break;
         }
     }
+    profile_leave(p->profiler);
 
     expect(p, TOKEN_RBRACE, "'}'");
 }
@@ -399,7 +904,7 @@ void parse_expression(Parser* p) {
         else if (type == TOKEN_RPAREN) {
             paren_count--;
             if (paren_count < 0) {
-                printf(" [ERROR: Unbalanced parentheses]");
+                fprintf(p->out, " [ERROR: Unbalanced parentheses]");
                 break;
             }
         }
@@ -407,7 +912,7 @@ void parse_expression(Parser* p) {
         else if (type == TOKEN_RBRACE) {
             brace_count--;
             if (brace_count < 0) {
-                printf(" [ERROR: Unbalanced braces]");
+                fprintf(p->out, " [ERROR: Unbalanced braces]");
                 break;
             }
         }
@@ -415,14 +920,14 @@ void parse_expression(Parser* p) {
         else if (type == TOKEN_RBRACKET) {
             bracket_count--;
             if (bracket_count < 0) {
-                printf(" [ERROR: Unbalanced brackets]");
+                fprintf(p->out, " [ERROR: Unbalanced brackets]");
                 break;
             }
         }
 
 
         if (paren_count > 0 || brace_count > 0 || bracket_count > 0) {
-            printf("%s ", current_token(p).value);
+            fprintf(p->out, "%s ", current_token(p).value);
             next_token(p);
             continue;
         }
@@ -432,20 +937,20 @@ void parse_expression(Parser* p) {
             break;
         }
 
-        printf("%s ", current_token(p).value);
+        fprintf(p->out, "%s ", current_token(p).value);
         next_token(p);
 
 
         if (p->pos > p->size) {
-            printf(" [ERROR: Parser position overflow]");
+            fprintf(p->out, " [ERROR: Parser position overflow]");
             break;
         }
     }
 
 
-    if (paren_count > 0) printf(" [ERROR: Unclosed parentheses]");
-    if (brace_count > 0) printf(" [ERROR: Unclosed braces]");
-    if (bracket_count > 0) printf(" [ERROR: Unclosed brackets]");
+    if (paren_count > 0) fprintf(p->out, " [ERROR: Unclosed parentheses]");
+    if (brace_count > 0) fprintf(p->out, " [ERROR: Unclosed braces]");
+    if (bracket_count > 0) fprintf(p->out, " [ERROR: Unclosed brackets]");
 }
 
 void parse_case_block(Parser* p) {
@@ -456,22 +961,22 @@ void parse_case_block(Parser* p) {
     int case_count = 0;
 
     while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
-        printf("  Pattern %d: ", ++case_count);
+        fprintf(p->out, "  Pattern %d: ", ++case_count);
 
 
         while (current_token(p).type != TOKEN_ARROW &&
                current_token(p).type != TOKEN_RBRACE &&
                current_token(p).type != TOKEN_EOF) {
-            printf("%s ", current_token(p).value);
+            fprintf(p->out, "%s ", current_token(p).value);
             next_token(p);
         }
 
         if (match(p, TOKEN_ARROW)) {
-            printf("-> ");
+            fprintf(p->out, "-> ");
             parse_expression(p);
         }
 
-        printf("\n");
+        fprintf(p->out, "\n");
 
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
@@ -480,7 +985,7 @@ void parse_case_block(Parser* p) {
 
 
         if (case_count > 1000) {
-            printf("Warning: Too many case patterns, stopping at 1000\n");
+            fprintf(p->out, "Warning: Too many case patterns, stopping at 1000\n");
             break;
         }
     }
@@ -488,6 +993,169 @@ void parse_case_block(Parser* p) {
     expect(p, TOKEN_RBRACE, "'}'");
 }
 
+//builds the definition from tokens [start, end) and evaluates it when it takes no arguments
+static void record_definition(Parser* p, const char* name, int start, int end) {
+    if (p->definition_count >= MAX_DEFINITIONS) {
+        fprintf(p->out, "Warning: Too many definitions (max %d), '%s' is not executable\n", MAX_DEFINITIONS, name);
+        return;
+    }
+
+    Definition def;
+    memset(&def, 0, sizeof(def));
+    def.name = expr_intern(p->exprs, name);
+
+    //optional parameter list: "x, y ." before the body
+    int pos = start;
+    while (pos + 1 < end && p->tokens[pos].type == TOKEN_IDENTIFIER &&
+           (p->tokens[pos+1].type == TOKEN_COMMA || p->tokens[pos+1].type == TOKEN_DOT)) {
+        if (def.param_count >= MAX_PARAMS) break;
+        def.params[def.param_count++] = expr_intern(p->exprs, p->tokens[pos].value);
+        pos += 2;
+        if (p->tokens[pos-1].type == TOKEN_DOT) break;
+    }
+    if (pos == start || p->tokens[pos-1].type != TOKEN_DOT) {
+        def.param_count = 0;
+        pos = start;
+    }
+
+    def.body = expr_parse(p->exprs, p->tokens, &pos, end);
+    if (pos < end && p->tokens[pos].type == TOKEN_SEMICOLON) pos++;
+    if (!def.body || pos != end) return;
+
+    Definition* slot = &p->definitions[p->definition_count++];
+    *slot = def;
+    if (slot->param_count > 0) return;
+
+    Evaluator ev;
+    evaluator_init(&ev, p->definitions, p->definition_count - 1);
+    ev.profiler = p->profiler;
+    ev.function = slot->name;
+    if (eval_expr(&ev, slot->body, &slot->value) == 0) {
+        slot->evaluated = 1;
+        char* text = rt_value_to_string(&slot->value);
+        if (text) fprintf(p->out, "  => %s\n", text);
+        free(text);
+    } else {
+        fprintf(p->out, "  => error: %s\n", ev.error);
+    }
+}
+
+//fixed_point NAME [with ROUNDS] where { initial x = e; x = step; ... }
+static void parse_fixed_point_system(Parser* p) {
+    expect(p, TOKEN_IDENTIFIER, "fixed-point name");
+    char fix_name[MAX_IDENTIFIER_LEN + 2];
+    safe_strcpy(fix_name, p->tokens[p->pos-1].value, sizeof(fix_name));
+
+    FixedPointSystem sys;
+    memset(&sys, 0, sizeof(sys));
+    sys.max_rounds = FIXPOINT_DEFAULT_ROUNDS;
+
+    if (match(p, TOKEN_WITH)) {
+        expect(p, TOKEN_NUMBER, "round limit");
+        size_t len;
+        const char* digits = number_text(p, p->pos-1, &len);
+
+        long long rounds = 0;
+        for (size_t i = 0; i < len && rounds <= INT_MAX; i++) {
+            rounds = rounds * 10 + (digits[i] - '0');
+        }
+        if (rounds <= 0 || rounds > INT_MAX) {
+            parser_error(p, "Invalid round limit for fixed point '%s'", fix_name);
+        }
+        sys.max_rounds = (int)rounds;
+    }
+
+    expect(p, TOKEN_WHERE, "'where'");
+    expect(p, TOKEN_LBRACE, "'{'");
+
+    fprintf(p->out, "Fixed-point system: %s (at most %d rounds)\n", fix_name, sys.max_rounds);
+    profile_enter(p->profiler, fix_name);
+
+    while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
+        int initial = match(p, TOKEN_INITIAL);
+        expect(p, TOKEN_IDENTIFIER, "fixed-point variable");
+        const char* var = expr_intern(p->exprs, p->tokens[p->pos-1].value);
+        expect(p, TOKEN_EQUALS, "'='");
+
+        int end = p->pos;
+        Expr* e = expr_parse(p->exprs, p->tokens, &end, p->size);
+        if (!e) parser_error(p, "Invalid equation for '%s' in fixed point '%s'", var, fix_name);
+
+        fprintf(p->out, "  %s%s = ", initial ? "initial " : "", var);
+        while (p->pos < end) {
+            fprintf(p->out, "%s ", current_token(p).value);
+            p->pos++;
+        }
+        fprintf(p->out, "\n");
+
+        FixedPointEquation* eq = NULL;
+        for (int i = 0; i < sys.count; i++) {
+            if (sys.equations[i].name == var) eq = &sys.equations[i];
+        }
+        if (!eq) {
+            if (sys.count >= MAX_FIXPOINT_VARS) {
+                parser_error(p, "Too many variables in fixed point '%s' (max %d)", fix_name, MAX_FIXPOINT_VARS);
+            }
+            eq = &sys.equations[sys.count++];
+            eq->name = var;
+        }
+
+        Expr** slot = initial ? &eq->initial : &eq->step;
+        if (*slot) {
+            parser_error(p, "Duplicate %s for '%s' in fixed point '%s'",
+                         initial ? "initial value" : "step", var, fix_name);
+        }
+        *slot = e;
+
+        if (current_token(p).type == TOKEN_SEMICOLON) {
+            match(p, TOKEN_SEMICOLON);
+        }
+    }
+
+    expect(p, TOKEN_RBRACE, "'}'");
+    if (current_token(p).type == TOKEN_SEMICOLON) {
+        match(p, TOKEN_SEMICOLON);
+    }
+
+    if (p->definition_count + sys.count > MAX_DEFINITIONS) {
+        parser_error(p, "Too many definitions (max %d)", MAX_DEFINITIONS);
+    }
+
+    //the variables become ordinary definitions once the iteration settles
+    int base = p->definition_count;
+    Definition* vars = &p->definitions[base];
+    for (int i = 0; i < sys.count; i++) {
+        memset(&vars[i], 0, sizeof(vars[i]));
+        vars[i].name = sys.equations[i].name;
+        vars[i].body = sys.equations[i].step ? sys.equations[i].step : sys.equations[i].initial;
+    }
+    p->definition_count += sys.count;
+
+    Evaluator ev;
+    evaluator_init(&ev, p->definitions, p->definition_count);
+    ev.profiler = p->profiler;
+    ev.function = fix_name;
+
+    if (fixed_point_solve(&sys, &ev, vars) == 0) {
+        fprintf(p->out, "  => converged after %d round(s), %d step evaluation(s)\n",
+                sys.rounds, sys.evaluations);
+        for (int i = 0; i < sys.count; i++) {
+            char* text = rt_value_to_string(&vars[i].value);
+            if (text) fprintf(p->out, "  => %s = %s\n", vars[i].name, text);
+            free(text);
+        }
+    } else {
+        fprintf(p->out, "  => error: %s\n", ev.error);
+        for (int i = 0; i < sys.count; i++) {
+            if (vars[i].evaluated) rt_value_release(&vars[i].value);
+            memset(&vars[i], 0, sizeof(vars[i]));
+        }
+        p->definition_count = base;
+    }
+
+    profile_leave(p->profiler);
+}
+
 void parse_algebraic_control(Parser* p) {
     if (!p) return;
 
@@ -497,28 +1165,41 @@ void parse_algebraic_control(Parser* p) {
         safe_strcpy(def_name, p->tokens[p->pos-1].value, sizeof(def_name));
 
         expect(p, TOKEN_AS, "'as'");
+        int body_start = p->pos;
 
-        printf("Algebraic definition: %s = ", def_name);
-        parse_expression(p);
-        printf("\n");
+        //the statement is named apart from the calls eval.c records under def_name
+        char site[PROFILE_NAME_LEN];
+        snprintf(site, sizeof(site), "define %s", def_name);
+        profile_enter(p->profiler, site);
 
+        fprintf(p->out, "Algebraic definition: %s = ", def_name);
+        parse_expression(p);
+        fprintf(p->out, "\n");
 
-        if (current_token(p).type == TOKEN_SEMICOLON) {
+        //a body such as "n . case n of { ... }" continues with the case analysis
+        if (current_token(p).type == TOKEN_CASE) {
+            parse_algebraic_control(p);
+        } else if (current_token(p).type == TOKEN_SEMICOLON) {
             match(p, TOKEN_SEMICOLON);
         }
+
+        record_definition(p, def_name, body_start, p->pos);
+        profile_leave(p->profiler);
     }
     else if (match(p, TOKEN_CASE)) {
-        printf("Case analysis on: ");
+        profile_enter(p->profiler, "case");
+        fprintf(p->out, "Case analysis on: ");
         parse_expression(p);
         expect(p, TOKEN_OF, "'of'");
 
-        printf("\nCase analysis:\n");
+        fprintf(p->out, "\nCase analysis:\n");
         parse_case_block(p);
 
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
             match(p, TOKEN_SEMICOLON);
         }
+        profile_leave(p->profiler);
     }
     else if (match(p, TOKEN_RECURSIVE)) {
         expect(p, TOKEN_IDENTIFIER, "recursive name");
@@ -528,13 +1209,15 @@ void parse_algebraic_control(Parser* p) {
         expect(p, TOKEN_WHERE, "'where'");
         expect(p, TOKEN_LBRACE, "'{'");
 
-        printf("Recursive definition: %s\n", rec_name);
+        fprintf(p->out, "Recursive definition: %s\n", rec_name);
+        profile_enter(p->profiler, rec_name);
 
         while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
             parse_algebraic_control(p);
         }
 
         expect(p, TOKEN_RBRACE, "'}'");
+        profile_leave(p->profiler);
 
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
@@ -542,14 +1225,22 @@ void parse_algebraic_control(Parser* p) {
         }
     }
     else if (match(p, TOKEN_FIXED_POINT)) {
-        printf("Fixed-point combinator: ");
+        if (current_token(p).type == TOKEN_IDENTIFIER && p->pos + 1 < p->size &&
+            (p->tokens[p->pos+1].type == TOKEN_WITH || p->tokens[p->pos+1].type == TOKEN_WHERE)) {
+            parse_fixed_point_system(p);
+            return;
+        }
+
+        profile_enter(p->profiler, "fixed_point");
+        fprintf(p->out, "Fixed-point combinator: ");
         parse_expression(p);
-        printf("\n");
+        fprintf(p->out, "\n");
 
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
             match(p, TOKEN_SEMICOLON);
         }
+        profile_leave(p->profiler);
     }
     else if (match(p, TOKEN_COLIMIT) || match(p, TOKEN_LIMIT)) {
         TokenType construct_type = p->tokens[p->pos-1].type;
@@ -562,21 +1253,22 @@ void parse_algebraic_control(Parser* p) {
         expect(p, TOKEN_WHERE, "'where'");
         expect(p, TOKEN_LBRACE, "'{'");
 
-        printf("Category theory %s: %s\n", construct_name, construct_id);
+        fprintf(p->out, "Category theory %s: %s\n", construct_name, construct_id);
+        profile_enter(p->profiler, construct_id);
 
         while (current_token(p).type != TOKEN_RBRACE && current_token(p).type != TOKEN_EOF) {
             parse_algebraic_control(p);
         }
 
         expect(p, TOKEN_RBRACE, "'}'");
+        profile_leave(p->profiler);
 
         if (current_token(p).type == TOKEN_SEMICOLON) {
             match(p, TOKEN_SEMICOLON);
         }
     }
     else {
-        printf("Error: Unknown algebraic control structure\n");
-        exit(1);
+        parser_error(p, "Unknown algebraic control structure");
     }
 }
 
@@ -594,6 +1286,8 @@ void parse(Parser* p) {
             parse_generators(p);
         } else if (current_token(p).type == TOKEN_RELATIONS) {
             parse_relations(p);
+        } else if (current_token(p).type == TOKEN_IMPORT) {
+            parse_import(p);
         } else if (current_token(p).type == TOKEN_DEFINE ||
                   current_token(p).type == TOKEN_CASE ||
                   current_token(p).type == TOKEN_RECURSIVE ||
@@ -609,7 +1303,7 @@ void parse(Parser* p) {
                 continue;
             }
 
-            printf("Warning: Unexpected token '%s' (type: %d), skipping\n",
+            fprintf(p->out, "Warning: Unexpected token '%s' (type: %d), skipping\n",
                    current_token(p).value, current_token(p).type);
             next_token(p);
         }
@@ -618,12 +1312,12 @@ void parse(Parser* p) {
 
 
         if (statement_count > 10000) {
-            printf("Error: Too many statements, possible infinite loop\n");
+            fprintf(p->out, "Error: Too many statements, possible infinite loop\n");
             break;
         }
 
         if (p->pos < 0 || p->pos > p->size) {
-            printf("Error: Parser position corrupted\n");
+            fprintf(p->out, "Error: Parser position corrupted\n");
             break;
         }
     }
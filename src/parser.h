@@ -1,27 +1,46 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdio.h>
 #include "lexer.h"
+#include "expr.h"
+#include "matrix.h"
+#include "mont.h"
+#include "echelon.h"
+#include "hnf.h"
+#include "eval.h"
 
 #define MAX_RINGS 50
 #define MAX_MODULES 50
+#define MAX_BLOCK_RELATIONS 1000
 #define MAX_IDENTIFIER_LEN 48
 
 typedef struct {
     char name[MAX_IDENTIFIER_LEN + 2];
     int is_finite_field;
-    int modulus;
+    long long modulus;
+    MontContext* mont;
+    int is_integer;
 } Ring;
 
 typedef struct {
     char name[MAX_IDENTIFIER_LEN + 2];
     Ring* base_ring;
     int dimension;
-    char** generators;
+    char (*generators)[MAX_IDENTIFIER_LEN + 2];
+    CoeffMatrix coeffs;
     int generator_count;
+
+    //relations among the generators, kept in reduced echelon form
+    Echelon relations;
+
+    //over the integers the relations are kept as a presentation matrix instead
+    IntMatrix presentation;
 } Module;
 
 typedef struct {
+    const char* source;
+    FILE* out;
     Token tokens[MAX_TOKENS];
     int pos;
     int size;
@@ -31,11 +50,37 @@ typedef struct {
 
     Module modules[MAX_MODULES];
     int module_count;
+
+    ExprPool* exprs;
+    int relation_count;
+    int relation_block_count;
+
+    Definition definitions[MAX_DEFINITIONS];
+    int definition_count;
+
+    Profiler* profiler;
+
+    //optional: relations are tested instead of solved (see check.h)
+    struct FastCheck* fast_check;
+
+    //optional: solved relations are looked up here before elimination (see store.h)
+    struct ResultStore* store;
+
+    //scratch owned by the statement being parsed, released if the parse is abandoned
+    void* pending;
 } Parser;
 
 
 Parser* parser_create(void);
 void parser_destroy(Parser* p);
+void parser_truncate(Parser* p, int ring_count, int module_count, int definition_count);
+void parser_error(Parser* p, const char* fmt, ...);
+
+Ring* parser_add_ring(Parser* p, const char* name, int is_finite_field, long long modulus,
+                      const MontContext* mont);
+Module* parser_add_module(Parser* p, const char* name, Ring* ring, int dimension);
+Ring* find_ring(Parser* p, const char* name);
+Module* find_module(Parser* p, const char* name);
 
 
 char* read_file(const char* filename);
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "profile.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+Profiler* profiler_create(void) {
+    Profiler* prof = calloc(1, sizeof(Profiler));
+    if (!prof) return NULL;
+
+    prof->root.entry = -1;
+    prof->current = &prof->root;
+    return prof;
+}
+
+static void free_children(ProfileNode* node) {
+    ProfileNode* child = node->child;
+    while (child) {
+        ProfileNode* next = child->sibling;
+        free_children(child);
+        free(child);
+        child = next;
+    }
+}
+
+void profiler_destroy(Profiler* prof) {
+    if (!prof) return;
+
+    free_children(&prof->root);
+    free(prof->entries);
+    free(prof);
+}
+
+static int find_entry(Profiler* prof, const char* name) {
+    for (int i = 0; i < prof->entry_count; i++) {
+        if (strcmp(prof->entries[i].name, name) == 0) return i;
+    }
+
+    if (prof->entry_count == prof->entry_capacity) {
+        int capacity = prof->entry_capacity ? prof->entry_capacity * 2 : 32;
+        ProfileEntry* grown = realloc(prof->entries, sizeof(ProfileEntry) * capacity);
+        if (!grown) return -1;
+        prof->entries = grown;
+        prof->entry_capacity = capacity;
+    }
+
+    ProfileEntry* entry = &prof->entries[prof->entry_count];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    return prof->entry_count++;
+}
+
+void profile_enter(Profiler* prof, const char* name) {
+    if (!prof) return;
+
+    //past the depth limit time is charged to the deepest recorded construct
+    if (prof->depth >= PROFILE_MAX_DEPTH) {
+        int entry = find_entry(prof, name);
+        if (entry >= 0) prof->entries[entry].calls++;
+        prof->overflow++;
+        return;
+    }
+
+    ProfileNode* parent = prof->current;
+    ProfileNode* node = parent->child;
+    while (node && strcmp(prof->entries[node->entry].name, name) != 0) {
+        node = node->sibling;
+    }
+
+    if (!node) {
+        int entry = find_entry(prof, name);
+        node = entry >= 0 ? calloc(1, sizeof(ProfileNode)) : NULL;
+        if (!node) {
+            prof->overflow++;
+            return;
+        }
+        node->entry = entry;
+        node->parent = parent;
+        node->sibling = parent->child;
+        parent->child = node;
+    }
+
+    ProfileEntry* entry = &prof->entries[node->entry];
+    entry->calls++;
+    entry->active++;
+    node->calls++;
+
+    prof->current = node;
+    prof->depth++;
+    node->started = now_ns();
+}
+
+void profile_enter_arm(Profiler* prof, const char* function, int arm) {
+    if (!prof) return;
+
+    char name[PROFILE_NAME_LEN];
+    snprintf(name, sizeof(name), "%s:arm %d", function ? function : "case", arm);
+    profile_enter(prof, name);
+}
+
+void profile_enter_index(Profiler* prof, const char* kind, int index) {
+    if (!prof) return;
+
+    char name[PROFILE_NAME_LEN];
+    snprintf(name, sizeof(name), "%s %d", kind, index);
+    profile_enter(prof, name);
+}
+
+void profile_leave(Profiler* prof) {
+    if (!prof) return;
+
+    if (prof->overflow > 0) {
+        prof->overflow--;
+        return;
+    }
+
+    ProfileNode* node = prof->current;
+    if (node == &prof->root) return;
+
+    uint64_t elapsed = now_ns() - node->started;
+    node->total_ns += elapsed;
+    node->parent->child_ns += elapsed;
+
+    //recursive activations count once towards the inclusive time
+    ProfileEntry* entry = &prof->entries[node->entry];
+    if (--entry->active == 0) entry->total_ns += elapsed;
+
+    prof->current = node->parent;
+    prof->depth--;
+}
+
+static void accumulate_self(const ProfileNode* node, ProfileEntry* entries) {
+    for (const ProfileNode* child = node->child; child; child = child->sibling) {
+        entries[child->entry].self_ns += child->total_ns - child->child_ns;
+        accumulate_self(child, entries);
+    }
+}
+
+static int by_self_time(const void* a, const void* b) {
+    const ProfileEntry* x = a;
+    const ProfileEntry* y = b;
+    if (x->self_ns != y->self_ns) return x->self_ns < y->self_ns ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+void profile_report(const Profiler* prof, FILE* out) {
+    if (!prof || !out) return;
+
+    int count = prof->entry_count;
+    ProfileEntry* entries = malloc(sizeof(ProfileEntry) * (count > 0 ? count : 1));
+    if (!entries) return;
+
+    memcpy(entries, prof->entries, sizeof(ProfileEntry) * count);
+    for (int i = 0; i < count; i++) {
+        entries[i].self_ns = 0;
+    }
+    accumulate_self(&prof->root, entries);
+    qsort(entries, count, sizeof(ProfileEntry), by_self_time);
+
+    fprintf(out, "Flat profile:\n");
+    fprintf(out, "  %10s %10s %10s  %s\n", "self ms", "total ms", "calls", "construct");
+    for (int i = 0; i < count; i++) {
+        const ProfileEntry* e = &entries[i];
+        fprintf(out, "  %10.3f %10.3f %10lld  %s\n",
+                e->self_ns / 1e6, e->total_ns / 1e6, e->calls, e->name);
+    }
+
+    free(entries);
+}
+
+static void write_stack(FILE* f, const Profiler* prof, const ProfileNode* node) {
+    if (node->parent != &prof->root) {
+        write_stack(f, prof, node->parent);
+        fputc(';', f);
+    }
+    fputs(prof->entries[node->entry].name, f);
+}
+
+//one "a;b;c <microseconds>" line per stack, the format flame graph tools read
+static void write_collapsed(FILE* f, const Profiler* prof, const ProfileNode* node) {
+    for (const ProfileNode* child = node->child; child; child = child->sibling) {
+        uint64_t self_us = (child->total_ns - child->child_ns) / 1000;
+        if (self_us > 0) {
+            write_stack(f, prof, child);
+            fprintf(f, " %llu\n", (unsigned long long)self_us);
+        }
+        write_collapsed(f, prof, child);
+    }
+}
+
+int profile_write_collapsed(const Profiler* prof, const char* path) {
+    if (!prof || !path) return -1;
+
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    write_collapsed(f, prof, &prof->root);
+    return fclose(f) == 0 ? 0 : -1;
+}
@@ -0,0 +1,53 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define PROFILE_MAX_DEPTH 1024
+#define PROFILE_NAME_LEN 112
+
+typedef struct {
+    char name[PROFILE_NAME_LEN];
+    long long calls;
+    uint64_t self_ns;
+    uint64_t total_ns;
+    int active;
+} ProfileEntry;
+
+//calling-context tree node; one per distinct stack of source constructs
+typedef struct ProfileNode {
+    int entry;
+    struct ProfileNode* parent;
+    struct ProfileNode* child;
+    struct ProfileNode* sibling;
+
+    long long calls;
+    uint64_t total_ns;
+    uint64_t child_ns;
+    uint64_t started;
+} ProfileNode;
+
+typedef struct {
+    ProfileNode root;
+    ProfileNode* current;
+    int depth;
+    int overflow;
+
+    ProfileEntry* entries;
+    int entry_count;
+    int entry_capacity;
+} Profiler;
+
+Profiler* profiler_create(void);
+void profiler_destroy(Profiler* prof);
+
+void profile_enter(Profiler* prof, const char* name);
+void profile_enter_arm(Profiler* prof, const char* function, int arm);
+void profile_enter_index(Profiler* prof, const char* kind, int index);
+void profile_leave(Profiler* prof);
+
+void profile_report(const Profiler* prof, FILE* out);
+int profile_write_collapsed(const Profiler* prof, const char* path);
+
+#endif
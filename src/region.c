@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "region.h"
+#include "fault.h"
+
+#define REGION_ALIGN 16
+
+struct RegionChunk {
+    RegionChunk* next;
+    size_t size;
+    size_t used;
+    unsigned char* data;
+};
+
+//per-thread state, so evaluations on different threads never contend for it;
+//spare chunks are kept between frames and returned once the outermost region ends
+static __thread Region* current;
+
+//left but not yet released: its memory is still in use while a result is copied out of it
+static __thread Region* left;
+static __thread RegionChunk* spare;
+static __thread int spare_count;
+
+static RegionChunk* chunk_create(size_t size) {
+    RegionChunk* c = malloc(sizeof(RegionChunk) + size + REGION_ALIGN);
+    if (!c) fault_out_of_memory("evaluation region");
+
+    uintptr_t start = (uintptr_t)(c + 1);
+    c->data = (unsigned char*)((start + REGION_ALIGN - 1) & ~(uintptr_t)(REGION_ALIGN - 1));
+    c->size = size;
+    c->used = 0;
+    return c;
+}
+
+void region_enter(Region* r) {
+    r->chunks = NULL;
+    r->outer = current;
+    current = r;
+}
+
+void region_leave(Region* r) {
+    if (current == r) {
+        current = r->outer;
+        left = r;
+    }
+}
+
+void region_release(Region* r) {
+    if (left == r) left = NULL;
+
+    RegionChunk* c = r->chunks;
+    while (c) {
+        RegionChunk* next = c->next;
+        if (c->size == REGION_CHUNK_SIZE && spare_count < REGION_SPARE_CHUNKS) {
+            c->next = spare;
+            spare = c;
+            spare_count++;
+        } else {
+            free(c);
+        }
+        c = next;
+    }
+    r->chunks = NULL;
+
+    if (!current) {
+        while (spare) {
+            RegionChunk* next = spare->next;
+            free(spare);
+            spare = next;
+        }
+        spare_count = 0;
+    }
+}
+
+Region* region_current(void) {
+    return current;
+}
+
+static int entered_after(const Region* r, const Region* to) {
+    for (const Region* o = r->outer; o; o = o->outer) {
+        if (o == to) return 1;
+    }
+    return to == NULL;
+}
+
+void region_unwind(Region* to) {
+    if (left && entered_after(left, to)) region_release(left);
+
+    while (current && current != to) {
+        Region* r = current;
+        current = r->outer;
+        region_release(r);
+    }
+}
+
+void* region_alloc(size_t size) {
+    Region* r = current;
+    if (!r) return NULL;
+
+    size = (size + REGION_ALIGN - 1) & ~(size_t)(REGION_ALIGN - 1);
+    RegionChunk* c = r->chunks;
+
+    if (!c || c->size - c->used < size) {
+        //large blocks get a chunk of their own behind the one being filled
+        if (size > REGION_CHUNK_SIZE / 4) {
+            RegionChunk* big = chunk_create(size);
+            big->used = size;
+            if (c) {
+                big->next = c->next;
+                c->next = big;
+            } else {
+                big->next = NULL;
+                r->chunks = big;
+            }
+            return big->data;
+        }
+
+        if (spare) {
+            c = spare;
+            spare = c->next;
+            spare_count--;
+            c->used = 0;
+        } else {
+            c = chunk_create(REGION_CHUNK_SIZE);
+        }
+        c->next = r->chunks;
+        r->chunks = c;
+    }
+
+    void* p = c->data + c->used;
+    c->used += size;
+    return p;
+}
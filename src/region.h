@@ -0,0 +1,32 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stddef.h>
+
+#define REGION_CHUNK_SIZE 8192
+#define REGION_SPARE_CHUNKS 64
+
+typedef struct RegionChunk RegionChunk;
+
+//bump allocation for one evaluation frame, freed in bulk when the frame ends;
+//regions nest per thread and allocation always goes to the innermost one
+typedef struct Region {
+    RegionChunk* chunks;
+    struct Region* outer;
+} Region;
+
+void region_enter(Region* r);
+
+//the outer region is current again, while memory of r stays valid until released;
+//an unwind in between releases it too
+void region_leave(Region* r);
+void region_release(Region* r);
+
+//releases every region entered after `to`, for errors that unwind past their frames
+Region* region_current(void);
+void region_unwind(Region* to);
+
+//NULL when the thread has no current region, in which case callers use the heap
+void* region_alloc(size_t size);
+
+#endif
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "store.h"
+
+#define STORE_MAGIC "SZR2"
+#define STORE_VERSION "syzygy-result-2"
+#define STORE_SUFFIX ".szr"
+
+//temporary files this old belong to a writer that died before renaming them
+#define STORE_STALE_SECONDS 3600
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define MIX_OFFSET 0x9e3779b97f4a7c15ULL
+#define MIX_PRIME 0xff51afd7ed558ccdULL
+
+static void digest(StoreKey* d, const void* data, size_t len) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        d->key = (d->key ^ bytes[i]) * FNV_PRIME;
+        d->check = (d->check + bytes[i] + 1) * MIX_PRIME;
+        d->check ^= d->check >> 29;
+    }
+}
+
+static void digest_int(StoreKey* d, long long value) {
+    digest(d, &value, sizeof(value));
+}
+
+static void digest_string(StoreKey* d, const char* s) {
+    digest(d, s, strlen(s) + 1);
+}
+
+static uint64_t checksum(const void* data, size_t len) {
+    StoreKey d = {FNV_OFFSET, MIX_OFFSET};
+    digest(&d, data, len);
+    return d.key;
+}
+
+static long long parse_limit(const char* text) {
+    char* end;
+    long long limit = strtoll(text, &end, 10);
+    if (end == text || limit < 0) return STORE_DEFAULT_LIMIT;
+
+    switch (*end) {
+        case 'k': case 'K': limit <<= 10; end++; break;
+        case 'm': case 'M': limit <<= 20; end++; break;
+        case 'g': case 'G': limit <<= 30; end++; break;
+    }
+    return *end ? STORE_DEFAULT_LIMIT : limit;
+}
+
+void result_store_init(ResultStore* s, const char* dir) {
+    memset(s, 0, sizeof(*s));
+    if (dir && strlen(dir) < sizeof(s->dir)) strcpy(s->dir, dir);
+
+    const char* limit = getenv("SYZYGY_CACHE_LIMIT");
+    s->limit = limit ? parse_limit(limit) : STORE_DEFAULT_LIMIT;
+}
+
+typedef struct {
+    const long long* entries;
+    int cols;
+    int sign;
+} Row;
+
+static int first_sign(const long long* entries, int cols) {
+    for (int j = 0; j < cols; j++) {
+        if (entries[j]) return entries[j] < 0 ? -1 : 1;
+    }
+    return 1;
+}
+
+static int compare_rows(const void* a, const void* b) {
+    const Row* x = a;
+    const Row* y = b;
+    for (int j = 0; j < x->cols; j++) {
+        long long u = x->sign * x->entries[j];
+        long long v = y->sign * y->entries[j];
+        if (u != v) return u < v ? -1 : 1;
+    }
+    return 0;
+}
+
+//the presentation is hashed as a set of rows up to sign: neither the order of the
+//relations nor the orientation of their sides changes the cokernel
+static void digest_presentation(StoreKey* d, const IntMatrix* m) {
+    digest_int(d, m->rows);
+    if (m->rows == 0) return;
+
+    Row* rows = malloc(sizeof(Row) * m->rows);
+    if (!rows) {
+        for (int i = 0; i < m->rows; i++) {
+            digest(d, m->entries + (size_t)i * m->cols, sizeof(long long) * m->cols);
+        }
+        return;
+    }
+
+    for (int i = 0; i < m->rows; i++) {
+        rows[i].entries = m->entries + (size_t)i * m->cols;
+        rows[i].cols = m->cols;
+        rows[i].sign = first_sign(rows[i].entries, m->cols);
+    }
+    qsort(rows, m->rows, sizeof(Row), compare_rows);
+
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) digest_int(d, rows[i].sign * rows[i].entries[j]);
+    }
+    free(rows);
+}
+
+//a reduced echelon form is determined by the span of the relations alone
+static void digest_echelon(StoreKey* d, const Echelon* e) {
+    digest_int(d, e->rank);
+
+    for (int c = 0; c < e->cols; c++) {
+        int row = e->pivot_row[c];
+        if (row < 0) continue;
+        digest_int(d, c);
+
+        if (e->mont || e->modulus > 2) {
+            digest(d, coeff_row(&e->rows, row), (size_t)e->cols * e->rows.elem_size);
+        } else if (e->modulus == 2) {
+            const uint64_t* bits = gf2_row(&e->bits, row);
+            for (int w = 0; w < (e->cols + 63) / 64; w++) {
+                uint64_t word = bits[w];
+                if (w == e->cols / 64) word &= ((uint64_t)1 << (e->cols & 63)) - 1;
+                digest(d, &word, sizeof(word));
+            }
+        } else {
+            const Rational* q = e->q + (size_t)row * e->cols;
+            for (int j = 0; j < e->cols; j++) {
+                char* text = rational_to_string(q[j]);
+                digest_string(d, text ? text : "?");
+                free(text);
+            }
+        }
+    }
+}
+
+//the ring and the generators, which every result about a module depends on
+static void digest_module(StoreKey* d, const Module* module) {
+    const Ring* ring = module->base_ring;
+    digest_int(d, ring->is_finite_field);
+    digest_int(d, ring->is_integer);
+    digest_int(d, ring->modulus);
+    if (ring->mont) digest(d, ring->mont->modulus, sizeof(limb_t) * ring->mont->limbs);
+
+    digest_int(d, module->dimension);
+    digest_int(d, module->generator_count);
+    for (int g = 0; g < module->dimension; g++) digest_string(d, module->generators[g]);
+
+    const CoeffMatrix* m = &module->coeffs;
+    digest_int(d, m->elem_size);
+    for (int row = 0; row < module->generator_count; row++) {
+        digest(d, coeff_row(m, row), (size_t)m->cols * m->elem_size);
+    }
+}
+
+StoreKey module_store_key(const Module* module) {
+    StoreKey d = {FNV_OFFSET, MIX_OFFSET};
+    digest_string(&d, STORE_VERSION);
+    digest_string(&d, "summary");
+    digest_module(&d, module);
+
+    if (module->base_ring->is_integer) digest_presentation(&d, &module->presentation);
+    else digest_echelon(&d, &module->relations);
+    return d;
+}
+
+StoreKey relations_store_key(const Module* module) {
+    StoreKey d = {FNV_OFFSET, MIX_OFFSET};
+    digest_string(&d, STORE_VERSION);
+    digest_string(&d, "relations");
+    digest_module(&d, module);
+    digest_echelon(&d, &module->relations);
+    return d;
+}
+
+//coefficients are hashed as the ring sees them, so -1 and p-1 name the same relation
+void relations_store_key_add(StoreKey* key, const Module* module, const Value* row) {
+    const Ring* ring = module->base_ring;
+    digest_int(key, module->dimension);
+    for (int j = 0; j < module->dimension; j++) {
+        if (ring->mont) {
+            limb_t c[MONT_MAX_LIMBS];
+            mont_from_value(ring->mont, c, row[j]);
+            digest(key, c, sizeof(limb_t) * ring->mont->limbs);
+        } else if (ring->modulus > 0) {
+            digest_int(key, value_mod_long(row[j], ring->modulus));
+        } else {
+            long long c;
+            if (value_to_long(row[j], &c) == 0) {
+                digest_int(key, c);
+            } else {
+                char* text = value_to_string(row[j]);
+                digest_string(key, text);
+                free(text);
+            }
+        }
+    }
+}
+
+static void entry_path(const ResultStore* s, uint64_t key, char* path, size_t size, const char* suffix) {
+    snprintf(path, size, "%s/%016llx%s", s->dir, (unsigned long long)key, suffix);
+}
+
+char* result_store_load(ResultStore* s, StoreKey key, size_t* len) {
+    if (!s->dir[0]) return NULL;
+
+    char path[STORE_PATH_LEN + 32];
+    entry_path(s, key.key, path, sizeof(path), STORE_SUFFIX);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        s->misses++;
+        return NULL;
+    }
+
+    char magic[4];
+    uint64_t stored_key, stored_check, size, sum;
+    char* data = NULL;
+    int ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, STORE_MAGIC, 4) == 0 &&
+             fread(&stored_key, sizeof(stored_key), 1, f) == 1 && stored_key == key.key &&
+             fread(&stored_check, sizeof(stored_check), 1, f) == 1 && stored_check == key.check &&
+             fread(&size, sizeof(size), 1, f) == 1 && size < (uint64_t)s->limit + 1;
+
+    if (ok) {
+        data = malloc((size_t)size + 1);
+        ok = data && fread(data, 1, (size_t)size, f) == (size_t)size &&
+             fread(&sum, sizeof(sum), 1, f) == 1 && sum == checksum(data, (size_t)size) &&
+             fgetc(f) == EOF;
+    }
+    fclose(f);
+
+    if (!ok) {
+        free(data);
+        s->misses++;
+        return NULL;
+    }
+
+    //a hit refreshes the entry's age for eviction
+    utime(path, NULL);
+    data[size] = '\0';
+    *len = (size_t)size;
+    s->hits++;
+    return data;
+}
+
+typedef struct {
+    char name[64];
+    long long size;
+    time_t mtime;
+} Entry;
+
+static int older_first(const void* a, const void* b) {
+    time_t x = ((const Entry*)a)->mtime;
+    time_t y = ((const Entry*)b)->mtime;
+    return x < y ? -1 : x > y;
+}
+
+//least recently used entries go first; a file another run is reading stays readable
+static void evict(const ResultStore* s) {
+    DIR* dir = opendir(s->dir);
+    if (!dir) return;
+
+    Entry* entries = NULL;
+    int count = 0, capacity = 0;
+    long long total = 0;
+    time_t now = time(NULL);
+    struct dirent* de;
+
+    while ((de = readdir(dir)) != NULL) {
+        size_t n = strlen(de->d_name);
+        int is_entry = n > 4 && strcmp(de->d_name + n - 4, STORE_SUFFIX) == 0;
+        int is_temp = n > 4 && strcmp(de->d_name + n - 4, ".tmp") == 0;
+        if ((!is_entry && !is_temp) || n >= sizeof(entries->name)) continue;
+
+        char path[STORE_PATH_LEN + 260];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", s->dir, de->d_name);
+        if (stat(path, &st) != 0) continue;
+
+        if (is_temp) {
+            if (now - st.st_mtime > STORE_STALE_SECONDS) remove(path);
+            continue;
+        }
+
+        if (count == capacity) {
+            int grown = capacity ? capacity * 2 : 64;
+            Entry* next = realloc(entries, sizeof(Entry) * grown);
+            if (!next) break;
+            entries = next;
+            capacity = grown;
+        }
+        strcpy(entries[count].name, de->d_name);
+        entries[count].size = (long long)st.st_size;
+        entries[count].mtime = st.st_mtime;
+        total += entries[count].size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > s->limit) {
+        qsort(entries, count, sizeof(Entry), older_first);
+        for (int i = 0; i < count && total > s->limit; i++) {
+            char path[STORE_PATH_LEN + 260];
+            snprintf(path, sizeof(path), "%s/%s", s->dir, entries[i].name);
+            remove(path);
+            total -= entries[i].size;
+        }
+    }
+    free(entries);
+}
+
+//written under a private name and renamed, so concurrent runs never see half an entry
+void result_store_save(ResultStore* s, StoreKey key, const char* data, size_t len) {
+    size_t file_size = 4 + 4 * sizeof(uint64_t) + len;
+    if (!s->dir[0] || (long long)file_size > s->limit) return;
+    mkdir(s->dir, 0777);
+
+    char path[STORE_PATH_LEN + 32];
+    char temp[STORE_PATH_LEN + 64];
+    char suffix[32];
+    entry_path(s, key.key, path, sizeof(path), STORE_SUFFIX);
+    snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long)getpid());
+    entry_path(s, key.key, temp, sizeof(temp), suffix);
+
+    FILE* f = fopen(temp, "wb");
+    if (!f) return;
+
+    uint64_t size = len;
+    uint64_t sum = checksum(data, len);
+    int ok = fwrite(STORE_MAGIC, 1, 4, f) == 4 &&
+             fwrite(&key.key, sizeof(key.key), 1, f) == 1 &&
+             fwrite(&key.check, sizeof(key.check), 1, f) == 1 &&
+             fwrite(&size, sizeof(size), 1, f) == 1 &&
+             fwrite(data, 1, len, f) == len &&
+             fwrite(&sum, sizeof(sum), 1, f) == 1;
+    if (fclose(f) != 0) ok = 0;
+
+    if (!ok || rename(temp, path) != 0) {
+        remove(temp);
+        return;
+    }
+    evict(s);
+}
@@ -0,0 +1,37 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parser.h"
+
+#define STORE_PATH_LEN 1024
+#define STORE_DEFAULT_LIMIT (64LL * 1024 * 1024)
+
+//two independent hashes of a structure's canonical content
+typedef struct {
+    uint64_t key;
+    uint64_t check;
+} StoreKey;
+
+//solved results on disk, shared by every run that points at the directory
+typedef struct ResultStore {
+    char dir[STORE_PATH_LEN];
+    long long limit;
+    int hits;
+    int misses;
+} ResultStore;
+
+void result_store_init(ResultStore* s, const char* dir);
+
+StoreKey module_store_key(const Module* module);
+
+//relations added to a module's current echelon form: start from the module, then add
+//each relation's coefficient row in order
+StoreKey relations_store_key(const Module* module);
+void relations_store_key_add(StoreKey* key, const Module* module, const Value* row);
+
+char* result_store_load(ResultStore* s, StoreKey key, size_t* len);
+void result_store_save(ResultStore* s, StoreKey key, const char* data, size_t len);
+
+#endif
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "summary.h"
+#include "linalg.h"
+
+//generators that the relations express through the remaining ones
+static void print_eliminated(FILE* out, Module* module) {
+    int n = module->dimension;
+    const char** names = calloc(n, sizeof(char*));
+    long long* unit = calloc(n, sizeof(long long));
+    if (!names || !unit) {
+        free(names);
+        free(unit);
+        return;
+    }
+    for (int g = 0; g < n; g++) names[g] = module->generators[g];
+
+    for (int g = 0; g < module->generator_count; g++) {
+        if (module->relations.pivot_row[g] < 0) continue;
+
+        unit[g] = 1;
+        char* normal = echelon_normal_form(&module->relations, unit, names);
+        unit[g] = 0;
+        if (normal) fprintf(out, "      %s = %s\n", names[g], normal);
+        free(normal);
+    }
+
+    free(names);
+    free(unit);
+}
+
+int module_cokernel(const Module* module, Cokernel* out) {
+    int n = module->generator_count;
+    IntMatrix relations;
+    memset(out, 0, sizeof(*out));
+    if (n == 0 || int_matrix_init(&relations, n) != 0) return -1;
+
+    for (int i = 0; i < module->presentation.rows; i++) {
+        int_matrix_append(&relations, module->presentation.entries + (size_t)i * module->dimension);
+    }
+    int status = int_matrix_cokernel(&relations, out);
+    int_matrix_free(&relations);
+    return status;
+}
+
+//the cokernel of an integer presentation, with its Hermite basis when it has full rank
+static void print_cokernel(FILE* out, Module* module) {
+    int n = module->generator_count;
+    if (n == 0) {
+        fprintf(out, "\n");
+        return;
+    }
+
+    Cokernel cokernel;
+    char* text = NULL;
+    int status = module_cokernel(module, &cokernel);
+    if (status == 0) text = cokernel_to_string(&cokernel);
+    fprintf(out, ", cokernel %s\n", text ? text : "unknown");
+    free(text);
+
+    for (int i = 0; text && cokernel.hnf && i < n; i++) {
+        fprintf(out, "     ");
+        int terms = 0;
+        for (int j = i; j < n; j++) {
+            Value x = cokernel.hnf[(size_t)i * n + j];
+            if (value_sign(x) == 0) continue;
+            char* digits = value_to_string(x);
+            if (!digits) continue;
+            fprintf(out, "%s%s%s%s", terms ? " + " : " ", strcmp(digits, "1") == 0 ? "" : digits,
+                    strcmp(digits, "1") == 0 ? "" : "*", module->generators[j]);
+            free(digits);
+            terms++;
+        }
+        fprintf(out, " = 0\n");
+    }
+
+    cokernel_free(&cokernel);
+}
+
+char* module_summary(Module* module, size_t* len) {
+    char* text = NULL;
+    FILE* out = open_memstream(&text, len);
+    if (!out) return NULL;
+
+    int rank = coeff_matrix_rank(&module->coeffs, module->generator_count,
+                                 module->base_ring->modulus, module->base_ring->mont);
+    if (rank >= 0) {
+        fprintf(out, "%d generators, rank %d", module->generator_count, rank);
+    } else {
+        fprintf(out, "%d generators, rank unknown", module->generator_count);
+    }
+
+    if (module->base_ring->is_integer && module->presentation.rows > 0) {
+        print_cokernel(out, module);
+    } else if (module->relations.rank == 0) {
+        fprintf(out, "\n");
+    } else {
+        fprintf(out, ", quotient dimension %d\n", module->generator_count - module->relations.rank);
+        print_eliminated(out, module);
+    }
+
+    if (fclose(out) != 0) {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
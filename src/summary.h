@@ -0,0 +1,13 @@
+#ifndef SUMMARY_H
+#define SUMMARY_H
+
+#include <stddef.h>
+#include "parser.h"
+
+//everything reported about a module after its name, as one block of text
+char* module_summary(Module* module, size_t* len);
+
+//Z^generators / relations of a module over the integers; free the result either way
+int module_cokernel(const Module* module, Cokernel* out);
+
+#endif
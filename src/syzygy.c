@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "syzygy.h"
+#include "parser.h"
+#include "linalg.h"
+#include "summary.h"
+#include "fault.h"
+#include "region.h"
+
+struct SyzContext {
+    Parser* parser;
+    SyzOutput output;
+    void* user;
+    SyzError error;
+
+    //tokens and diagnostics point into the sources, so each one lives as long as the context
+    char** sources;
+    int source_count;
+    int source_capacity;
+
+    //kept off the stack: longjmp leaves automatic variables indeterminate
+    Fault fault;
+
+    //the buffer of the call in progress, released if a fault abandons it
+    void* scratch;
+};
+
+//fatal errors raised while a call runs unwind to here and become its status
+#define SYZ_GUARD(ctx, failed)                 \
+    if (setjmp((ctx)->fault.env) != 0) {       \
+        recover(ctx);                          \
+        return failed;                         \
+    }                                          \
+    fault_install(&(ctx)->fault)
+
+static void set_error(SyzContext* ctx, SyzStatus status, const char* message) {
+    ctx->error.status = status;
+    ctx->error.line = 0;
+    ctx->error.column = 0;
+    snprintf(ctx->error.message, sizeof(ctx->error.message), "%s", message);
+}
+
+static void clear_error(SyzContext* ctx) {
+    memset(&ctx->error, 0, sizeof(ctx->error));
+}
+
+static void locate(SyzContext* ctx, const char* source, int offset) {
+    if (!source || offset < 0) return;
+
+    int line = 1, column = 1;
+    for (int i = 0; i < offset && source[i]; i++) {
+        if (source[i] == '\n') {
+            line++;
+            column = 1;
+        } else {
+            column++;
+        }
+    }
+    ctx->error.line = line;
+    ctx->error.column = column;
+}
+
+static void recover(SyzContext* ctx) {
+    Parser* p = ctx->parser;
+    free(p->pending);
+    p->pending = NULL;
+    free(ctx->scratch);
+    ctx->scratch = NULL;
+
+    set_error(ctx, ctx->fault.out_of_memory ? SYZ_ERROR_MEMORY : SYZ_ERROR_SOURCE, ctx->fault.message);
+    locate(ctx, p->source, ctx->fault.offset);
+}
+
+SyzContext* syz_create(void) {
+    SyzContext* ctx = calloc(1, sizeof(SyzContext));
+    if (!ctx) return NULL;
+
+    ctx->parser = parser_create();
+    if (!ctx->parser) {
+        free(ctx);
+        return NULL;
+    }
+    ctx->parser->out = NULL;
+    return ctx;
+}
+
+void syz_destroy(SyzContext* ctx) {
+    if (!ctx) return;
+
+    parser_destroy(ctx->parser);
+    for (int i = 0; i < ctx->source_count; i++) free(ctx->sources[i]);
+    free(ctx->sources);
+    free(ctx);
+}
+
+void syz_set_output(SyzContext* ctx, SyzOutput output, void* user) {
+    if (!ctx) return;
+    ctx->output = output;
+    ctx->user = user;
+}
+
+const SyzError* syz_last_error(const SyzContext* ctx) {
+    return ctx ? &ctx->error : NULL;
+}
+
+static char* keep_source(SyzContext* ctx, const char* source, size_t len) {
+    if (ctx->source_count == ctx->source_capacity) {
+        int grown = ctx->source_capacity ? ctx->source_capacity * 2 : 4;
+        char** next = realloc(ctx->sources, sizeof(char*) * grown);
+        if (!next) return NULL;
+        ctx->sources = next;
+        ctx->source_capacity = grown;
+    }
+
+    char* copy = malloc(len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, source, len);
+    copy[len] = '\0';
+    ctx->sources[ctx->source_count++] = copy;
+    return copy;
+}
+
+//imports are resolved by the file driver, which a buffer has no directory for
+static int find_import(const Parser* p) {
+    for (int i = 0; i < p->size; i++) {
+        if (p->tokens[i].type == TOKEN_IMPORT) return i;
+    }
+    return -1;
+}
+
+static void parse_source(SyzContext* ctx) {
+    SYZ_GUARD(ctx, );
+    parse(ctx->parser);
+    fault_remove(&ctx->fault);
+}
+
+SyzStatus syz_load(SyzContext* ctx, const char* source, size_t len) {
+    if (!ctx) return SYZ_ERROR_ARGUMENT;
+    clear_error(ctx);
+    if (!source) {
+        set_error(ctx, SYZ_ERROR_ARGUMENT, "No source given");
+        return ctx->error.status;
+    }
+
+    char* copy = keep_source(ctx, source, len);
+    char* text = NULL;
+    size_t text_len = 0;
+    FILE* out = copy ? open_memstream(&text, &text_len) : NULL;
+    if (!out) {
+        set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for source");
+        return ctx->error.status;
+    }
+
+    Parser* p = ctx->parser;
+    int count = 0;
+    if (tokenize(copy, p->tokens, &count, out) != 0) {
+        p->size = 0;
+        set_error(ctx, SYZ_ERROR_SOURCE, "Cannot tokenize source");
+    } else {
+        p->source = copy;
+        p->size = count;
+        p->pos = 0;
+
+        int import = find_import(p);
+        if (import >= 0) {
+            set_error(ctx, SYZ_ERROR_UNSUPPORTED, "Imports are only available when loading files");
+            locate(ctx, copy, p->tokens[import].offset);
+        } else {
+            p->out = out;
+            parse_source(ctx);
+            p->out = NULL;
+        }
+    }
+
+    fclose(out);
+    if (ctx->output && text_len > 0) ctx->output(ctx->user, text, text_len);
+    free(text);
+    return ctx->error.status;
+}
+
+int syz_ring_count(const SyzContext* ctx) {
+    return ctx ? ctx->parser->ring_count : 0;
+}
+
+SyzStatus syz_ring(SyzContext* ctx, int index, SyzRing* out) {
+    if (!ctx) return SYZ_ERROR_ARGUMENT;
+    clear_error(ctx);
+    if (!out || index < 0 || index >= ctx->parser->ring_count) {
+        set_error(ctx, SYZ_ERROR_NOT_FOUND, "No such ring");
+        return ctx->error.status;
+    }
+
+    const Ring* ring = &ctx->parser->rings[index];
+    out->name = ring->name;
+    out->kind = ring->is_integer ? SYZ_RING_INTEGERS :
+                ring->is_finite_field ? SYZ_RING_INTEGERS_MOD : SYZ_RING_RATIONALS;
+    return SYZ_OK;
+}
+
+char* syz_ring_modulus(SyzContext* ctx, int index) {
+    if (!ctx) return NULL;
+    clear_error(ctx);
+    if (index < 0 || index >= ctx->parser->ring_count) {
+        set_error(ctx, SYZ_ERROR_NOT_FOUND, "No such ring");
+        return NULL;
+    }
+
+    const Ring* ring = &ctx->parser->rings[index];
+    if (!ring->mont) {
+        char* text = malloc(24);
+        if (text) snprintf(text, 24, "%lld", ring->is_finite_field ? ring->modulus : 0);
+        else set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for modulus");
+        return text;
+    }
+
+    //the limbs are folded in 32 bits at a time to stay within value_from_long
+    SYZ_GUARD(ctx, NULL);
+    Value n = value_from_fixnum(0);
+    Value shift = value_from_long(1LL << 32);
+    for (int i = ring->mont->limbs - 1; i >= 0; i--) {
+        for (int half = 1; half >= 0; half--) {
+            Value digit = value_from_long((long long)((ring->mont->modulus[i] >> (32 * half)) & 0xffffffffULL));
+            Value scaled = value_mul(n, shift);
+            value_release(n);
+            n = value_add(scaled, digit);
+            value_release(scaled);
+            value_release(digit);
+        }
+    }
+    char* text = value_to_string(n);
+    value_release(n);
+    value_release(shift);
+    fault_remove(&ctx->fault);
+    return text;
+}
+
+int syz_module_count(const SyzContext* ctx) {
+    return ctx ? ctx->parser->module_count : 0;
+}
+
+int syz_find_module(const SyzContext* ctx, const char* name) {
+    if (!ctx || !name) return -1;
+
+    for (int i = 0; i < ctx->parser->module_count; i++) {
+        if (strcmp(ctx->parser->modules[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static Module* module_at(SyzContext* ctx, int index) {
+    clear_error(ctx);
+    if (index < 0 || index >= ctx->parser->module_count) {
+        set_error(ctx, SYZ_ERROR_NOT_FOUND, "No such module");
+        return NULL;
+    }
+    return &ctx->parser->modules[index];
+}
+
+SyzStatus syz_module(SyzContext* ctx, int index, SyzModule* out) {
+    if (!ctx) return SYZ_ERROR_ARGUMENT;
+    Module* module = module_at(ctx, index);
+    if (!module) return ctx->error.status;
+    if (!out) {
+        set_error(ctx, SYZ_ERROR_ARGUMENT, "No module record given");
+        return ctx->error.status;
+    }
+
+    SYZ_GUARD(ctx, ctx->error.status);
+    out->name = module->name;
+    out->ring = module->base_ring->name;
+    out->dimension = module->dimension;
+    out->generator_count = module->generator_count;
+    out->rank = coeff_matrix_rank(&module->coeffs, module->generator_count,
+                                  module->base_ring->modulus, module->base_ring->mont);
+    out->relation_rank = module->base_ring->is_integer ? module->presentation.rows
+                                                       : module->relations.rank;
+    fault_remove(&ctx->fault);
+    return SYZ_OK;
+}
+
+const char* syz_generator(const SyzContext* ctx, int module, int index) {
+    if (!ctx || module < 0 || module >= ctx->parser->module_count) return NULL;
+
+    const Module* m = &ctx->parser->modules[module];
+    if (index < 0 || index >= m->generator_count) return NULL;
+    return m->generators[index];
+}
+
+char* syz_module_summary(SyzContext* ctx, int index) {
+    if (!ctx) return NULL;
+    Module* module = module_at(ctx, index);
+    if (!module) return NULL;
+
+    SYZ_GUARD(ctx, NULL);
+    size_t len;
+    char* text = module_summary(module, &len);
+    fault_remove(&ctx->fault);
+
+    if (!text) set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for summary");
+    return text;
+}
+
+char* syz_normal_form(SyzContext* ctx, int index, const long long* coeffs) {
+    if (!ctx) return NULL;
+    Module* module = module_at(ctx, index);
+    if (!module) return NULL;
+    if (!coeffs) {
+        set_error(ctx, SYZ_ERROR_ARGUMENT, "No coefficients given");
+        return NULL;
+    }
+    if (module->base_ring->is_integer) {
+        set_error(ctx, SYZ_ERROR_UNSUPPORTED, "Normal forms need a field; use the cokernel over the integers");
+        return NULL;
+    }
+
+    //the vector and the names share one block, the scratch a fault releases
+    int n = module->dimension;
+    long long* vector = calloc(n, sizeof(long long) + sizeof(char*));
+    if (!vector) {
+        set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for normal form");
+        return NULL;
+    }
+    const char** names = (const char**)(vector + n);
+    for (int g = 0; g < n; g++) names[g] = module->generators[g];
+    for (int g = 0; g < module->generator_count; g++) vector[g] = coeffs[g];
+    ctx->scratch = vector;
+
+    SYZ_GUARD(ctx, NULL);
+    char* text = echelon_normal_form(&module->relations, vector, names);
+    fault_remove(&ctx->fault);
+
+    ctx->scratch = NULL;
+    free(vector);
+    if (!text) set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for normal form");
+    return text;
+}
+
+char* syz_cokernel(SyzContext* ctx, int index) {
+    if (!ctx) return NULL;
+    Module* module = module_at(ctx, index);
+    if (!module) return NULL;
+    if (!module->base_ring->is_integer) {
+        set_error(ctx, SYZ_ERROR_UNSUPPORTED, "Cokernels are classified over the integers only");
+        return NULL;
+    }
+
+    SYZ_GUARD(ctx, NULL);
+    Cokernel cokernel;
+    char* text = NULL;
+    if (module_cokernel(module, &cokernel) == 0) text = cokernel_to_string(&cokernel);
+    cokernel_free(&cokernel);
+    fault_remove(&ctx->fault);
+
+    if (!text) set_error(ctx, SYZ_ERROR_MEMORY, "Cannot classify the cokernel");
+    return text;
+}
+
+//an expression over the context's definitions, parsed with the same grammar as a file
+char* syz_evaluate(SyzContext* ctx, const char* expression) {
+    if (!ctx) return NULL;
+    clear_error(ctx);
+    if (!expression) {
+        set_error(ctx, SYZ_ERROR_ARGUMENT, "No expression given");
+        return NULL;
+    }
+
+    Token* tokens = malloc(sizeof(Token) * MAX_TOKENS);
+    if (!tokens) {
+        set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for tokens");
+        return NULL;
+    }
+
+    int count = 0;
+    if (tokenize(expression, tokens, &count, NULL) != 0) {
+        free(tokens);
+        set_error(ctx, SYZ_ERROR_SOURCE, "Cannot tokenize expression");
+        return NULL;
+    }
+
+    Parser* p = ctx->parser;
+    ctx->scratch = tokens;
+    SYZ_GUARD(ctx, NULL);
+
+    //count includes the end-of-input token
+    int pos = 0;
+    int end = count - 1;
+    Expr* e = expr_parse(p->exprs, tokens, &pos, end);
+    char* text = NULL;
+    if (!e || pos != end) {
+        set_error(ctx, SYZ_ERROR_SOURCE, "Invalid expression");
+        ctx->error.line = 1;
+        ctx->error.column = pos < count ? tokens[pos].offset + 1 : 1;
+    } else {
+        //the value lives in a region of the call's own, which a fault unwinds with the rest
+        Evaluator ev;
+        RtValue value;
+        Region region;
+        evaluator_init(&ev, p->definitions, p->definition_count);
+        region_enter(&region);
+        if (eval_expr(&ev, e, &value) != 0) {
+            set_error(ctx, SYZ_ERROR_EVALUATION, ev.error);
+        } else {
+            text = rt_value_to_string(&value);
+            rt_value_release(&value);
+            if (!text) set_error(ctx, SYZ_ERROR_MEMORY, "Memory allocation failed for value");
+        }
+        region_leave(&region);
+        region_release(&region);
+    }
+    fault_remove(&ctx->fault);
+
+    ctx->scratch = NULL;
+    free(tokens);
+    return text;
+}
+
+void syz_free(void* text) {
+    free(text);
+}
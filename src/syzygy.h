@@ -0,0 +1,86 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include <stddef.h>
+
+//embedding API: a context owns everything it loads and reports errors instead of
+//exiting, so separate contexts may be used from different threads at once
+#if defined(__GNUC__)
+#define SYZ_API __attribute__((visibility("default")))
+#else
+#define SYZ_API
+#endif
+
+#define SYZ_MESSAGE_LEN 256
+
+typedef struct SyzContext SyzContext;
+
+typedef enum {
+    SYZ_OK = 0,
+    SYZ_ERROR_ARGUMENT,
+    SYZ_ERROR_SOURCE,
+    SYZ_ERROR_UNSUPPORTED,
+    SYZ_ERROR_NOT_FOUND,
+    SYZ_ERROR_EVALUATION,
+    SYZ_ERROR_MEMORY
+} SyzStatus;
+
+//line and column are 1-based and 0 when the error has no position in the source
+typedef struct {
+    SyzStatus status;
+    int line;
+    int column;
+    char message[SYZ_MESSAGE_LEN];
+} SyzError;
+
+typedef enum {
+    SYZ_RING_INTEGERS_MOD,
+    SYZ_RING_RATIONALS,
+    SYZ_RING_INTEGERS
+} SyzRingKind;
+
+typedef struct {
+    const char* name;
+    SyzRingKind kind;
+} SyzRing;
+
+//rank is that of the generator coefficients, -1 when it cannot be computed;
+//relation_rank counts independent relations over a field and relations over Z
+typedef struct {
+    const char* name;
+    const char* ring;
+    int dimension;
+    int generator_count;
+    int rank;
+    int relation_rank;
+} SyzModule;
+
+//receives everything a load reports, in the order the command line prints it
+typedef void (*SyzOutput)(void* user, const char* text, size_t len);
+
+SYZ_API SyzContext* syz_create(void);
+SYZ_API void syz_destroy(SyzContext* ctx);
+SYZ_API void syz_set_output(SyzContext* ctx, SyzOutput output, void* user);
+
+//sources accumulate; a failed load keeps what was declared before the error
+SYZ_API SyzStatus syz_load(SyzContext* ctx, const char* source, size_t len);
+SYZ_API const SyzError* syz_last_error(const SyzContext* ctx);
+
+SYZ_API int syz_ring_count(const SyzContext* ctx);
+SYZ_API SyzStatus syz_ring(SyzContext* ctx, int index, SyzRing* out);
+
+SYZ_API int syz_module_count(const SyzContext* ctx);
+SYZ_API int syz_find_module(const SyzContext* ctx, const char* name);
+SYZ_API SyzStatus syz_module(SyzContext* ctx, int index, SyzModule* out);
+SYZ_API const char* syz_generator(const SyzContext* ctx, int module, int index);
+
+//strings returned below are owned by the caller and released with syz_free;
+//the modulus of a ring of characteristic zero is "0"
+SYZ_API char* syz_ring_modulus(SyzContext* ctx, int index);
+SYZ_API char* syz_module_summary(SyzContext* ctx, int index);
+SYZ_API char* syz_normal_form(SyzContext* ctx, int module, const long long* coeffs);
+SYZ_API char* syz_cokernel(SyzContext* ctx, int module);
+SYZ_API char* syz_evaluate(SyzContext* ctx, const char* expression);
+SYZ_API void syz_free(void* text);
+
+#endif
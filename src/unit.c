@@ -0,0 +1,799 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "unit.h"
+
+#define UNIT_MAGIC "SZU5"
+#define UNIT_VERSION "syzygy-unit-5"
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t len) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+//directory part of a path with its trailing slash, empty for a bare file name
+static void dir_of(const char* path, char* dir, size_t size) {
+    const char* slash = strrchr(path, '/');
+    size_t len = slash ? (size_t)(slash - path) + 1 : 0;
+    if (len >= size) len = size - 1;
+    memcpy(dir, path, len);
+    dir[len] = '\0';
+}
+
+//depth-first discovery; dependencies get their keys and levels before the importer
+static int visit(UnitGraph* g, const char* path, int* index) {
+    char canonical[UNIT_PATH_LEN];
+    if (!realpath(path, canonical)) {
+        printf("Error: Cannot open file %s\n", path);
+        return -1;
+    }
+
+    for (int i = 0; i < g->unit_count; i++) {
+        if (strcmp(g->units[i].canonical, canonical) == 0) {
+            if (g->units[i].visiting) {
+                printf("Error: Import cycle through %s\n", path);
+                return -1;
+            }
+            *index = i;
+            return 0;
+        }
+    }
+
+    if (g->unit_count >= MAX_UNITS) {
+        printf("Error: Too many imported files (max %d)\n", MAX_UNITS);
+        return -1;
+    }
+
+    int self = g->unit_count++;
+    Unit* u = &g->units[self];
+    safe_strcpy(u->path, path, sizeof(u->path));
+    safe_strcpy(u->canonical, canonical, sizeof(u->canonical));
+    u->visiting = 1;
+
+    u->source = read_file(path);
+    if (!u->source) return -1;
+
+    u->parser = parser_create();
+    if (!u->parser) return -1;
+
+    int token_count;
+    if (tokenize(u->source, u->parser->tokens, &token_count, stdout) != 0) {
+        printf("Error: Cannot tokenize %s\n", path);
+        return -1;
+    }
+    u->parser->size = token_count;
+    u->parser->source = u->source;
+
+    char dir[UNIT_PATH_LEN];
+    dir_of(path, dir, sizeof(dir));
+
+    const Token* tokens = u->parser->tokens;
+    for (int t = 0; t + 1 < token_count; t++) {
+        if (tokens[t].type != TOKEN_IMPORT || tokens[t+1].type != TOKEN_STRING) continue;
+
+        char target[UNIT_PATH_LEN];
+        if (tokens[t+1].value[0] == '/') {
+            safe_strcpy(target, tokens[t+1].value, sizeof(target));
+        } else if (strlen(dir) + strlen(tokens[t+1].value) < sizeof(target)) {
+            strcpy(target, dir);
+            strcat(target, tokens[t+1].value);
+        } else {
+            printf("Error: Import path too long in %s\n", path);
+            return -1;
+        }
+
+        int dep;
+        if (visit(g, target, &dep) != 0) return -1;
+
+        int known = 0;
+        for (int i = 0; i < u->dep_count; i++) {
+            if (u->deps[i] == dep) known = 1;
+        }
+        if (known) continue;
+
+        if (u->dep_count >= MAX_UNIT_DEPS) {
+            printf("Error: Too many imports in %s (max %d)\n", path, MAX_UNIT_DEPS);
+            return -1;
+        }
+        u->deps[u->dep_count++] = dep;
+    }
+
+    u->key = fnv1a(FNV_OFFSET, UNIT_VERSION, strlen(UNIT_VERSION));
+    u->key = fnv1a(u->key, u->source, strlen(u->source));
+    for (int i = 0; i < u->dep_count; i++) {
+        const Unit* dep = &g->units[u->deps[i]];
+        if (dep->level + 1 > u->level) u->level = dep->level + 1;
+        u->key = fnv1a(u->key, &dep->key, sizeof(dep->key));
+    }
+
+    if (u->level + 1 > g->level_count) g->level_count = u->level + 1;
+    u->visiting = 0;
+    *index = self;
+    return 0;
+}
+
+UnitGraph* unit_graph_load(const char* root_path) {
+    UnitGraph* g = calloc(1, sizeof(UnitGraph));
+    if (!g) {
+        printf("Error: Memory allocation failed for import graph\n");
+        return NULL;
+    }
+
+    //SYZYGY_CACHE_DIR lets many jobs share one cache; set but empty, it disables caching
+    const char* shared = getenv("SYZYGY_CACHE_DIR");
+    char dir[UNIT_PATH_LEN];
+    dir_of(root_path, dir, sizeof(dir));
+    if (shared) {
+        if (strlen(shared) < sizeof(g->cache_dir)) strcpy(g->cache_dir, shared);
+    } else if (strlen(dir) + strlen(UNIT_CACHE_DIR) < sizeof(g->cache_dir)) {
+        strcpy(g->cache_dir, dir);
+        strcat(g->cache_dir, UNIT_CACHE_DIR);
+    }
+
+    int root;
+    if (visit(g, root_path, &root) != 0) {
+        unit_graph_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+void unit_graph_destroy(UnitGraph* g) {
+    if (!g) return;
+
+    for (int i = 0; i < g->unit_count; i++) {
+        parser_destroy(g->units[i].parser);
+        free(g->units[i].source);
+        free(g->units[i].output);
+    }
+    free(g);
+}
+
+static void import_structures(Parser* dst, Unit* from) {
+    Parser* src = from->parser;
+
+    for (int i = from->ring_start; i < from->ring_end; i++) {
+        const Ring* ring = &src->rings[i];
+        Ring* copy = parser_add_ring(dst, ring->name, ring->is_finite_field, ring->modulus, ring->mont);
+        copy->is_integer = ring->is_integer;
+    }
+
+    for (int i = from->module_start; i < from->module_end; i++) {
+        const Module* module = &src->modules[i];
+        Ring* ring = find_ring(dst, module->base_ring->name);
+        Module* copy = parser_add_module(dst, module->name, ring, module->dimension);
+
+        memcpy(copy->generators, module->generators,
+               sizeof(*module->generators) * module->dimension);
+        memcpy(copy->coeffs.data, module->coeffs.data, module->coeffs.stride * module->coeffs.rows);
+        copy->generator_count = module->generator_count;
+
+        //the relations come along, so the quotient is the same as in its own file
+        const IntMatrix* presentation = &module->presentation;
+        int ok = echelon_copy(&copy->relations, &module->relations) == 0;
+        for (int row = 0; ok && row < presentation->rows; row++) {
+            ok = int_matrix_append(&copy->presentation,
+                                   presentation->entries + (size_t)row * presentation->cols) == 0;
+        }
+        if (!ok) parser_error(dst, "Memory allocation failed for relations of %s", module->name);
+    }
+
+    //bodies are re-interned, since names and nodes are compared by identity within a pool
+    for (int i = from->definition_start; i < from->definition_end; i++) {
+        const Definition* def = &src->definitions[i];
+        if (dst->definition_count >= MAX_DEFINITIONS) {
+            parser_error(dst, "Too many definitions (max %d)", MAX_DEFINITIONS);
+        }
+
+        Definition* copy = &dst->definitions[dst->definition_count];
+        memset(copy, 0, sizeof(*copy));
+        copy->name = expr_intern(dst->exprs, def->name);
+        copy->param_count = def->param_count;
+        for (int k = 0; k < def->param_count; k++) copy->params[k] = expr_intern(dst->exprs, def->params[k]);
+        copy->body = expr_copy(dst->exprs, def->body);
+        if (!copy->body) parser_error(dst, "Cannot import definition '%s'", def->name);
+        if (def->evaluated) {
+            copy->value = rt_value_copy(&def->value);
+            copy->evaluated = 1;
+        }
+        dst->definition_count++;
+    }
+}
+
+static void collect_imports(const UnitGraph* g, int index, char* seen, int* order, int* count) {
+    const Unit* u = &g->units[index];
+    for (int i = 0; i < u->dep_count; i++) {
+        int dep = u->deps[i];
+        if (seen[dep]) continue;
+        seen[dep] = 1;
+        collect_imports(g, dep, seen, order, count);
+        order[(*count)++] = dep;
+    }
+}
+
+//everything a file imports, directly or not, is visible to it in dependency order
+static void import_dependencies(UnitGraph* g, int index) {
+    char seen[MAX_UNITS] = {0};
+    int order[MAX_UNITS];
+    int count = 0;
+    collect_imports(g, index, seen, order, &count);
+
+    Unit* u = &g->units[index];
+    for (int i = 0; i < count; i++) {
+        import_structures(u->parser, &g->units[order[i]]);
+    }
+    u->ring_start = u->parser->ring_count;
+    u->module_start = u->parser->module_count;
+    u->definition_start = u->parser->definition_count;
+}
+
+static void cache_path(const UnitGraph* g, const Unit* u, char* path, size_t size, const char* suffix) {
+    snprintf(path, size, "%s/%016llx%s", g->cache_dir, (unsigned long long)u->key, suffix);
+}
+
+static int put(FILE* f, const void* data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, f) == size;
+}
+
+static int put_int(FILE* f, int32_t value) {
+    return put(f, &value, sizeof(value));
+}
+
+static int put_string(FILE* f, const char* s) {
+    size_t len = strlen(s) + 1;
+    return put_int(f, (int32_t)len) && put(f, s, len);
+}
+
+//prefix order: the kind, then whatever of name, operands and items that kind has
+static int put_expr(FILE* f, const Expr* e) {
+    int ok = put_int(f, e->kind);
+    switch (e->kind) {
+        case EXPR_NUMBER:
+        case EXPR_VARIABLE:
+            return ok && put_string(f, e->name);
+        case EXPR_NEG:
+            return ok && put_expr(f, e->left);
+        case EXPR_CALL:
+            ok = ok && put_string(f, e->name);
+            break;
+        case EXPR_TUPLE:
+            break;
+        case EXPR_CASE:
+            ok = ok && put_expr(f, e->left);
+            break;
+        default:
+            return ok && put_expr(f, e->left) && put_expr(f, e->right);
+    }
+
+    ok = ok && put_int(f, e->item_count);
+    for (int i = 0; ok && i < e->item_count; i++) ok = put_expr(f, e->items[i]);
+    return ok;
+}
+
+static int put_value(FILE* f, const RtValue* v) {
+    int ok = put_int(f, v->kind);
+    if (v->kind == RT_NUMBER) {
+        char* num = value_to_string(v->number.num);
+        char* den = value_to_string(v->number.den);
+        ok = ok && put_string(f, num) && put_string(f, den);
+        free(num);
+        free(den);
+        return ok;
+    }
+
+    ok = ok && put_int(f, v->item_count);
+    for (int i = 0; ok && i < v->item_count; i++) ok = put_value(f, &v->items[i]);
+    return ok;
+}
+
+static int write_unit(FILE* f, const Unit* u) {
+    const Parser* p = u->parser;
+    uint64_t output_len = u->output_len;
+
+    int ok = put(f, UNIT_MAGIC, 4) && put(f, &u->key, sizeof(u->key)) &&
+             put(f, &output_len, sizeof(output_len)) && put(f, u->output, u->output_len);
+
+    ok = ok && put_int(f, u->ring_end - u->ring_start);
+    for (int i = u->ring_start; ok && i < u->ring_end; i++) {
+        const Ring* ring = &p->rings[i];
+        int limbs = ring->mont ? ring->mont->limbs : 0;
+        int64_t modulus = ring->modulus;
+        ok = put(f, ring->name, sizeof(ring->name)) && put_int(f, ring->is_finite_field) &&
+             put_int(f, ring->is_integer) && put(f, &modulus, sizeof(modulus)) && put_int(f, limbs) &&
+             (limbs == 0 || put(f, ring->mont->modulus, sizeof(limb_t) * limbs));
+    }
+
+    ok = ok && put_int(f, u->module_end - u->module_start);
+    for (int i = u->module_start; ok && i < u->module_end; i++) {
+        const Module* module = &p->modules[i];
+        const CoeffMatrix* m = &module->coeffs;
+        ok = put(f, module->name, sizeof(module->name)) &&
+             put(f, module->base_ring->name, sizeof(module->base_ring->name)) &&
+             put_int(f, module->dimension) && put_int(f, module->generator_count) &&
+             put(f, module->generators, sizeof(*module->generators) * module->dimension) &&
+             put_int(f, m->elem_size);
+        for (int row = 0; ok && row < m->rows; row++) {
+            ok = put(f, coeff_row(m, row), (size_t)m->cols * m->elem_size);
+        }
+
+        size_t len;
+        unsigned char* relations = ok ? echelon_encode(&module->relations, &len) : NULL;
+        uint64_t relations_len = relations ? len : 0;
+        ok = relations && put(f, &relations_len, sizeof(relations_len)) && put(f, relations, len);
+        free(relations);
+
+        const IntMatrix* presentation = &module->presentation;
+        ok = ok && put_int(f, presentation->rows) &&
+             put(f, presentation->entries, sizeof(long long) * presentation->rows * presentation->cols);
+    }
+
+    ok = ok && put_int(f, u->definition_end - u->definition_start);
+    for (int i = u->definition_start; ok && i < u->definition_end; i++) {
+        const Definition* def = &p->definitions[i];
+        ok = put_string(f, def->name) && put_int(f, def->param_count);
+        for (int k = 0; ok && k < def->param_count; k++) ok = put_string(f, def->params[k]);
+        ok = ok && put_expr(f, def->body) && put_int(f, def->evaluated) &&
+             (!def->evaluated || put_value(f, &def->value));
+    }
+    return ok;
+}
+
+//written under a private name and renamed, so concurrent runs never see half a file
+static void save_unit(const UnitGraph* g, const Unit* u) {
+    if (!g->cache_dir[0]) return;
+    mkdir(g->cache_dir, 0777);
+
+    char path[UNIT_PATH_LEN + 32];
+    char temp[UNIT_PATH_LEN + 64];
+    char suffix[32];
+    cache_path(g, u, path, sizeof(path), ".szu");
+    snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long)getpid());
+    cache_path(g, u, temp, sizeof(temp), suffix);
+
+    FILE* f = fopen(temp, "wb");
+    if (!f) return;
+
+    int ok = write_unit(f, u);
+    if (fclose(f) != 0) ok = 0;
+
+    if (!ok || rename(temp, path) != 0) remove(temp);
+}
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+} Reader;
+
+static const void* take(Reader* r, size_t size) {
+    if (size > r->size - r->pos) return NULL;
+    const void* at = r->data + r->pos;
+    r->pos += size;
+    return at;
+}
+
+static int take_int(Reader* r, int32_t* value) {
+    const void* at = take(r, sizeof(*value));
+    if (!at) return 0;
+    memcpy(value, at, sizeof(*value));
+    return 1;
+}
+
+static const char* take_string(Reader* r) {
+    int32_t len;
+    if (!take_int(r, &len) || len <= 0) return NULL;
+    const char* s = take(r, (size_t)len);
+    return s && memchr(s, '\0', (size_t)len) == s + len - 1 ? s : NULL;
+}
+
+//without a pool the tree is only checked; depth is bounded like the source it came from
+static int take_expr(Reader* r, ExprPool* pool, int depth, Expr** out) {
+    int32_t kind, count = 0;
+    if (depth > MAX_TOKENS || !take_int(r, &kind) || kind < EXPR_NUMBER || kind > EXPR_ARM) return 0;
+
+    const char* name = NULL;
+    Expr* left = NULL;
+    Expr* right = NULL;
+    Expr* items[EXPR_MAX_ITEMS];
+
+    switch (kind) {
+        case EXPR_NUMBER:
+        case EXPR_VARIABLE:
+        case EXPR_CALL:
+            if (!(name = take_string(r))) return 0;
+            break;
+        case EXPR_TUPLE:
+            break;
+        case EXPR_NEG:
+        case EXPR_CASE:
+            if (!take_expr(r, pool, depth + 1, &left)) return 0;
+            break;
+        default:
+            if (!take_expr(r, pool, depth + 1, &left) || !take_expr(r, pool, depth + 1, &right)) return 0;
+            break;
+    }
+
+    if (kind == EXPR_CALL || kind == EXPR_TUPLE || kind == EXPR_CASE) {
+        if (!take_int(r, &count) || count < 0 || count > EXPR_MAX_ITEMS) return 0;
+        for (int i = 0; i < count; i++) {
+            if (!take_expr(r, pool, depth + 1, &items[i])) return 0;
+        }
+    }
+    if (!pool) return 1;
+
+    switch (kind) {
+        case EXPR_NUMBER: *out = expr_number(pool, name); break;
+        case EXPR_VARIABLE: *out = expr_variable(pool, name); break;
+        case EXPR_NEG: *out = expr_unary(pool, kind, left); break;
+        case EXPR_CALL: *out = expr_call(pool, name, items, count); break;
+        case EXPR_TUPLE: *out = expr_tuple(pool, items, count); break;
+        case EXPR_CASE: *out = expr_case(pool, left, items, count); break;
+        default: *out = expr_binary(pool, kind, left, right); break;
+    }
+    return *out != NULL;
+}
+
+static int take_number(Reader* r, Value* out) {
+    const char* text = take_string(r);
+    return text && value_parse(text, strlen(text), out) == 0;
+}
+
+//without apply the value is only checked; a partly built value is released by the caller
+static int take_value(Reader* r, int apply, int depth, RtValue* out) {
+    int32_t kind;
+    memset(out, 0, sizeof(*out));
+    if (depth > MAX_TOKENS || !take_int(r, &kind)) return 0;
+
+    if (kind == RT_NUMBER) {
+        if (!apply) return take_string(r) && take_string(r);
+        out->kind = RT_NUMBER;
+        out->number.num = value_from_fixnum(0);
+        out->number.den = value_from_fixnum(1);
+        Value num, den;
+        if (!take_number(r, &num)) return 0;
+        if (!take_number(r, &den)) {
+            value_release(num);
+            return 0;
+        }
+        out->number.num = num;
+        out->number.den = den;
+        return value_sign(den) > 0;
+    }
+
+    int32_t count;
+    if (kind != RT_TUPLE || !take_int(r, &count) || count < 0 || count > EXPR_MAX_ITEMS) return 0;
+    out->kind = RT_TUPLE;
+    if (apply && count > 0) {
+        out->items = calloc((size_t)count, sizeof(RtValue));
+        if (!out->items) return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        RtValue item;
+        int ok = take_value(r, apply, depth + 1, apply ? &out->items[i] : &item);
+        if (apply) out->item_count = i + 1;
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+//first pass only validates, the second one (apply) fills the unit's parser
+static int decode_unit(Unit* u, const unsigned char* data, size_t size, int apply) {
+    Reader r = {data, size, 0};
+    Parser* p = u->parser;
+
+    const void* magic = take(&r, 4);
+    const void* key = take(&r, sizeof(u->key));
+    const void* output_len = take(&r, sizeof(uint64_t));
+    if (!magic || !key || !output_len || memcmp(magic, UNIT_MAGIC, 4) != 0 ||
+        memcmp(key, &u->key, sizeof(u->key)) != 0) {
+        return -1;
+    }
+
+    uint64_t len;
+    memcpy(&len, output_len, sizeof(len));
+    const char* output = take(&r, (size_t)len);
+    if (!output) return -1;
+
+    if (apply) {
+        u->output = malloc((size_t)len + 1);
+        if (!u->output) return -1;
+        memcpy(u->output, output, (size_t)len);
+        u->output[len] = '\0';
+        u->output_len = (size_t)len;
+    }
+
+    int32_t ring_count;
+    if (!take_int(&r, &ring_count) || ring_count < 0 || ring_count > MAX_RINGS) return -1;
+
+    for (int i = 0; i < ring_count; i++) {
+        const char* name = take(&r, sizeof(p->rings[0].name));
+        int32_t is_finite_field, is_integer, limbs;
+        int64_t modulus;
+        const void* modulus_at = NULL;
+        if (!name || !take_int(&r, &is_finite_field) || !take_int(&r, &is_integer) ||
+            !(modulus_at = take(&r, sizeof(modulus))) || !take_int(&r, &limbs) ||
+            limbs < 0 || limbs > MONT_MAX_LIMBS) {
+            return -1;
+        }
+        memcpy(&modulus, modulus_at, sizeof(modulus));
+        if (modulus < 0) return -1;
+
+        const void* digits = take(&r, sizeof(limb_t) * limbs);
+        if (!digits || memchr(name, '\0', sizeof(p->rings[0].name)) == NULL) return -1;
+
+        MontContext mont;
+        if (limbs > 0) {
+            limb_t modulus_limbs[MONT_MAX_LIMBS];
+            memcpy(modulus_limbs, digits, sizeof(limb_t) * limbs);
+            if (mont_init_limbs(&mont, modulus_limbs, limbs) != 0) return -1;
+        }
+        if (apply) {
+            Ring* ring = parser_add_ring(p, name, is_finite_field, modulus, limbs > 0 ? &mont : NULL);
+            ring->is_integer = is_integer != 0;
+        }
+    }
+
+    int32_t module_count;
+    if (!take_int(&r, &module_count) || module_count < 0 || module_count > MAX_MODULES) return -1;
+
+    for (int i = 0; i < module_count; i++) {
+        const char* name = take(&r, sizeof(p->modules[0].name));
+        const char* ring_name = take(&r, sizeof(p->rings[0].name));
+        int32_t dimension, generator_count, elem_size;
+        if (!name || !ring_name || !take_int(&r, &dimension) || !take_int(&r, &generator_count) ||
+            dimension <= 0 || generator_count < 0 || generator_count > dimension) {
+            return -1;
+        }
+
+        if (memchr(name, '\0', sizeof(p->modules[0].name)) == NULL ||
+            memchr(ring_name, '\0', sizeof(p->rings[0].name)) == NULL) {
+            return -1;
+        }
+
+        const void* generators = take(&r, sizeof(*p->modules[0].generators) * dimension);
+        if (!generators || !take_int(&r, &elem_size) || elem_size <= 0 ||
+            elem_size > (int32_t)(MONT_MAX_LIMBS * sizeof(limb_t))) {
+            return -1;
+        }
+
+        size_t row_size = (size_t)dimension * elem_size;
+        const unsigned char* rows = take(&r, row_size * dimension);
+        const void* relations_len = take(&r, sizeof(uint64_t));
+        if (!rows || !relations_len) return -1;
+
+        uint64_t len;
+        memcpy(&len, relations_len, sizeof(len));
+        const unsigned char* relations = take(&r, (size_t)len);
+        int32_t presentation_rows;
+        if (!relations || !take_int(&r, &presentation_rows) || presentation_rows < 0) return -1;
+
+        size_t presentation_size = sizeof(long long) * dimension;
+        const unsigned char* presentation = take(&r, presentation_size * presentation_rows);
+        if (!presentation) return -1;
+        if (!apply) continue;
+
+        //a ring that is missing or of another width means the entry cannot be trusted
+        Ring* ring = find_ring(p, ring_name);
+        if (!ring) return -1;
+
+        Module* module = parser_add_module(p, name, ring, dimension);
+        if (module->coeffs.elem_size != elem_size ||
+            echelon_decode(&module->relations, relations, (size_t)len) != 0) {
+            return -1;
+        }
+
+        memcpy(module->generators, generators, sizeof(*module->generators) * dimension);
+        for (int row = 0; row < dimension; row++) {
+            memcpy(coeff_row(&module->coeffs, row), rows + row_size * row, row_size);
+        }
+        module->generator_count = generator_count;
+
+        long long* entries = presentation_rows > 0 ? malloc(presentation_size) : NULL;
+        if (presentation_rows > 0 && !entries) return -1;
+        for (int row = 0; row < presentation_rows; row++) {
+            memcpy(entries, presentation + presentation_size * row, presentation_size);
+            if (int_matrix_append(&module->presentation, entries) != 0) {
+                free(entries);
+                return -1;
+            }
+        }
+        free(entries);
+    }
+
+    int32_t definition_count;
+    if (!take_int(&r, &definition_count) || definition_count < 0 ||
+        definition_count > MAX_DEFINITIONS - p->definition_count) {
+        return -1;
+    }
+
+    for (int i = 0; i < definition_count; i++) {
+        Definition def;
+        memset(&def, 0, sizeof(def));
+        const char* name = take_string(&r);
+        int32_t param_count, evaluated;
+        if (!name || !take_int(&r, &param_count) || param_count < 0 || param_count > MAX_PARAMS) return -1;
+
+        def.name = apply ? expr_intern(p->exprs, name) : name;
+        def.param_count = param_count;
+        for (int k = 0; k < param_count; k++) {
+            const char* param = take_string(&r);
+            if (!param) return -1;
+            def.params[k] = apply ? expr_intern(p->exprs, param) : param;
+        }
+
+        if (!take_expr(&r, apply ? p->exprs : NULL, 0, &def.body) || !take_int(&r, &evaluated)) return -1;
+        if (evaluated) {
+            int ok = take_value(&r, apply, 0, &def.value);
+            if (!ok) {
+                if (apply) rt_value_release(&def.value);
+                return -1;
+            }
+            def.evaluated = 1;
+        }
+        if (apply) p->definitions[p->definition_count++] = def;
+    }
+
+    return r.pos == r.size ? 0 : -1;
+}
+
+static int load_unit(const UnitGraph* g, Unit* u) {
+    if (!g->cache_dir[0]) return -1;
+
+    char path[UNIT_PATH_LEN + 32];
+    cache_path(g, u, path, sizeof(path), ".szu");
+
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    unsigned char* data = size > 0 ? malloc((size_t)size) : NULL;
+    int status = -1;
+    if (data && fread(data, 1, (size_t)size, f) == (size_t)size &&
+        decode_unit(u, data, (size_t)size, 0) == 0) {
+        int ring_count = u->parser->ring_count;
+        int module_count = u->parser->module_count;
+        int definition_count = u->parser->definition_count;
+        status = decode_unit(u, data, (size_t)size, 1);
+
+        //an entry that only fails once applied is a miss as well: undo it and recompile
+        if (status != 0) {
+            parser_truncate(u->parser, ring_count, module_count, definition_count);
+            free(u->output);
+            u->output = NULL;
+            u->output_len = 0;
+        }
+    }
+
+    free(data);
+    fclose(f);
+    return status;
+}
+
+//parse with output captured, so concurrent files can be replayed in a fixed order
+static void compile_unit(Unit* u) {
+    FILE* out = tmpfile();
+    if (!out) parser_error(u->parser, "Cannot capture output for %s", u->path);
+
+    u->parser->out = out;
+    parse(u->parser);
+
+    fflush(out);
+    long len = ftell(out);
+    rewind(out);
+
+    u->output = malloc(len > 0 ? (size_t)len + 1 : 1);
+    if (!u->output) parser_error(u->parser, "Memory allocation failed for output of %s", u->path);
+    u->output_len = len > 0 ? fread(u->output, 1, (size_t)len, out) : 0;
+    u->output[u->output_len] = '\0';
+
+    u->parser->out = stdout;
+    fclose(out);
+}
+
+typedef struct {
+    Unit** units;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} WorkQueue;
+
+static void* compile_worker(void* arg) {
+    WorkQueue* queue = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (index >= queue->count) break;
+        compile_unit(queue->units[index]);
+    }
+    return NULL;
+}
+
+static void compile_parallel(Unit** units, int count) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = cpus < 1 ? 1 : (cpus < count ? (int)cpus : count);
+
+    WorkQueue queue;
+    queue.units = units;
+    queue.count = count;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    pthread_t threads[MAX_UNITS];
+    int started = 0;
+
+    if (thread_count > 1) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, UNIT_THREAD_STACK);
+        while (started < thread_count &&
+               pthread_create(&threads[started], &attr, compile_worker, &queue) == 0) {
+            started++;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    //the calling thread drains whatever the workers have not claimed
+    compile_worker(&queue);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+}
+
+//compiles every import level by level, then exposes the imports to the root parser
+void unit_graph_compile_imports(UnitGraph* g) {
+    if (!g) return;
+
+    for (int level = 0; level < g->level_count; level++) {
+        Unit* work[MAX_UNITS];
+        int work_count = 0;
+
+        for (int i = 1; i < g->unit_count; i++) {
+            Unit* u = &g->units[i];
+            if (u->level != level) continue;
+
+            import_dependencies(g, i);
+            if (load_unit(g, u) == 0) {
+                u->cached = 1;
+            } else {
+                work[work_count++] = u;
+            }
+        }
+
+        compile_parallel(work, work_count);
+
+        for (int i = 1; i < g->unit_count; i++) {
+            Unit* u = &g->units[i];
+            if (u->level != level) continue;
+
+            u->ring_end = u->parser->ring_count;
+            u->module_end = u->parser->module_count;
+            u->definition_end = u->parser->definition_count;
+
+            printf("Importing file: %s%s\n", u->path, u->cached ? " (cached)" : "");
+            fwrite(u->output, 1, u->output_len, stdout);
+            printf("----------------------------------------\n");
+
+            if (!u->cached) save_unit(g, u);
+        }
+    }
+
+    import_dependencies(g, 0);
+}
@@ -0,0 +1,50 @@
+#ifndef UNIT_H
+#define UNIT_H
+
+#include <stdint.h>
+#include "parser.h"
+
+#define MAX_UNITS 64
+#define MAX_UNIT_DEPS 32
+#define UNIT_PATH_LEN 1024
+#define UNIT_CACHE_DIR ".szcache"
+#define UNIT_THREAD_STACK (16 * 1024 * 1024)
+
+//one source file together with the parser that compiles it
+typedef struct {
+    char path[UNIT_PATH_LEN];
+    char canonical[UNIT_PATH_LEN];
+    char* source;
+    Parser* parser;
+
+    int deps[MAX_UNIT_DEPS];
+    int dep_count;
+    int level;
+    int visiting;
+
+    //content hash folded with the keys of every dependency
+    uint64_t key;
+    int cached;
+
+    //rings, modules and definitions declared by this file itself, after the imported ones
+    int ring_start, ring_end;
+    int module_start, module_end;
+    int definition_start, definition_end;
+
+    char* output;
+    size_t output_len;
+} Unit;
+
+//import graph rooted at units[0]; the root is parsed by the caller on its own
+typedef struct {
+    Unit units[MAX_UNITS];
+    int unit_count;
+    int level_count;
+    char cache_dir[UNIT_PATH_LEN];
+} UnitGraph;
+
+UnitGraph* unit_graph_load(const char* root_path);
+void unit_graph_compile_imports(UnitGraph* g);
+void unit_graph_destroy(UnitGraph* g);
+
+#endif
@@ -0,0 +1,769 @@
+#include <stdlib.h>
+#include <string.h>
+#include "value.h"
+#include "fault.h"
+#include "region.h"
+
+typedef struct {
+    int sign;
+    int size;
+
+    //allocated in an evaluation region, which frees it in bulk
+    int in_region;
+    uint32_t limbs[];
+} BigInt;
+
+//magnitude view of any value, limbs point either into a bignum or at small
+typedef struct {
+    int sign;
+    int size;
+    const uint32_t* limbs;
+    uint32_t small[2];
+} Mag;
+
+static BigInt* big_alloc(int size) {
+    size_t bytes = sizeof(BigInt) + sizeof(uint32_t) * (size_t)(size > 0 ? size : 1);
+    BigInt* b = region_alloc(bytes);
+    int in_region = b != NULL;
+    if (!b) b = malloc(bytes);
+    if (!b) {
+        fault_out_of_memory("big integer");
+    }
+    memset(b->limbs, 0, sizeof(uint32_t) * (size_t)(size > 0 ? size : 1));
+    b->sign = 1;
+    b->size = size;
+    b->in_region = in_region;
+    return b;
+}
+
+static void big_free(BigInt* b) {
+    if (!b->in_region) free(b);
+}
+
+static void mag_view(Value v, Mag* m) {
+    if (value_is_fixnum(v)) {
+        intptr_t i = value_fixnum(v);
+        unsigned long long u = i < 0 ? 0ULL - (unsigned long long)i : (unsigned long long)i;
+        m->small[0] = (uint32_t)u;
+        m->small[1] = (uint32_t)(u >> 32);
+        m->size = m->small[1] ? 2 : (m->small[0] ? 1 : 0);
+        m->sign = i < 0 ? -1 : (i > 0);
+        m->limbs = m->small;
+    } else {
+        const BigInt* b = (const BigInt*)v;
+        m->sign = b->sign;
+        m->size = b->size;
+        m->limbs = b->limbs;
+    }
+}
+
+//turns a freshly computed bignum into its canonical value, demoting to a fixnum when it fits
+static Value finish(BigInt* b, int sign) {
+    while (b->size > 0 && b->limbs[b->size - 1] == 0) b->size--;
+
+    if (b->size <= 2) {
+        unsigned long long u = b->size == 0 ? 0 :
+                               (b->size == 1 ? b->limbs[0] :
+                                ((unsigned long long)b->limbs[1] << 32) | b->limbs[0]);
+        //the fixnum range is one wider on the negative side
+        if (u <= (unsigned long long)VALUE_FIXNUM_MAX ||
+            (sign < 0 && u == (unsigned long long)VALUE_FIXNUM_MAX + 1)) {
+            big_free(b);
+            return value_from_long(sign < 0 ? -(long long)(u - 1) - 1 : (long long)u);
+        }
+    }
+
+    b->sign = sign < 0 ? -1 : 1;
+    return (Value)b;
+}
+
+Value value_from_long(long long n) {
+    if (n >= VALUE_FIXNUM_MIN && n <= VALUE_FIXNUM_MAX) return value_from_fixnum((intptr_t)n);
+
+    unsigned long long u = n < 0 ? 0ULL - (unsigned long long)n : (unsigned long long)n;
+    BigInt* b = big_alloc(2);
+    b->limbs[0] = (uint32_t)u;
+    b->limbs[1] = (uint32_t)(u >> 32);
+    return finish(b, n < 0 ? -1 : 1);
+}
+
+Value value_copy(Value v) {
+    if (value_is_fixnum(v)) return v;
+
+    const BigInt* src = (const BigInt*)v;
+    BigInt* b = big_alloc(src->size);
+    b->sign = src->sign;
+    memcpy(b->limbs, src->limbs, sizeof(uint32_t) * src->size);
+    return (Value)b;
+}
+
+void value_release(Value v) {
+    if (v && !value_is_fixnum(v)) big_free((BigInt*)v);
+}
+
+static int mag_cmp(const uint32_t* a, int na, const uint32_t* b, int nb) {
+    if (na != nb) return na > nb ? 1 : -1;
+    for (int i = na - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] > b[i] ? 1 : -1;
+    }
+    return 0;
+}
+
+//out has room for max(na, nb) + 1 limbs
+static int mag_add(uint32_t* out, const uint32_t* a, int na, const uint32_t* b, int nb) {
+    if (na < nb) {
+        const uint32_t* t = a; a = b; b = t;
+        int tn = na; na = nb; nb = tn;
+    }
+
+    uint64_t carry = 0;
+    for (int i = 0; i < na; i++) {
+        uint64_t s = (uint64_t)a[i] + (i < nb ? b[i] : 0) + carry;
+        out[i] = (uint32_t)s;
+        carry = s >> 32;
+    }
+    out[na] = (uint32_t)carry;
+    return na + 1;
+}
+
+//requires a >= b, out has room for na limbs
+static int mag_sub(uint32_t* out, const uint32_t* a, int na, const uint32_t* b, int nb) {
+    int64_t borrow = 0;
+    for (int i = 0; i < na; i++) {
+        int64_t d = (int64_t)a[i] - (i < nb ? b[i] : 0) - borrow;
+        borrow = d < 0;
+        out[i] = (uint32_t)(d + (borrow ? ((int64_t)1 << 32) : 0));
+    }
+    return na;
+}
+
+//out (na + nb limbs) is accumulated into, so callers clear it first
+static void mul_school(uint32_t* out, const uint32_t* a, int na, const uint32_t* b, int nb) {
+    for (int i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        if (!ai) continue;
+        for (int j = 0; j < nb; j++) {
+            uint64_t t = ai * b[j] + out[i + j] + carry;
+            out[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        for (int k = i + nb; carry; k++) {
+            uint64_t t = (uint64_t)out[k] + carry;
+            out[k] = (uint32_t)t;
+            carry = t >> 32;
+        }
+    }
+}
+
+static void add_into(uint32_t* out, int n_out, const uint32_t* a, int na) {
+    uint64_t carry = 0;
+    for (int i = 0; i < n_out && (i < na || carry); i++) {
+        uint64_t s = (uint64_t)out[i] + (i < na ? a[i] : 0) + carry;
+        out[i] = (uint32_t)s;
+        carry = s >> 32;
+    }
+}
+
+static void sub_into(uint32_t* out, int n_out, const uint32_t* a, int na) {
+    int64_t borrow = 0;
+    for (int i = 0; i < n_out && (i < na || borrow); i++) {
+        int64_t d = (int64_t)out[i] - (i < na ? a[i] : 0) - borrow;
+        borrow = d < 0;
+        out[i] = (uint32_t)(d + (borrow ? ((int64_t)1 << 32) : 0));
+    }
+}
+
+//out (2n limbs) = a * b for two n-limb operands
+static void mul_karatsuba(uint32_t* out, const uint32_t* a, const uint32_t* b, int n) {
+    memset(out, 0, sizeof(uint32_t) * 2 * (size_t)n);
+    if (n < VALUE_KARATSUBA_THRESHOLD) {
+        mul_school(out, a, n, b, n);
+        return;
+    }
+
+    int h = n / 2;
+    int hi = n - h;
+    int m = hi + 1;
+
+    uint32_t* scratch = calloc((size_t)(4 * m), sizeof(uint32_t));
+    if (!scratch) {
+        fault_out_of_memory("big integer");
+    }
+    uint32_t* sa = scratch;
+    uint32_t* sb = scratch + m;
+    uint32_t* z1 = scratch + 2 * m;
+
+    mul_karatsuba(out, a, b, h);
+    mul_karatsuba(out + 2 * h, a + h, b + h, hi);
+
+    mag_add(sa, a + h, hi, a, h);
+    mag_add(sb, b + h, hi, b, h);
+    mul_karatsuba(z1, sa, sb, m);
+
+    sub_into(z1, 2 * m, out, 2 * h);
+    sub_into(z1, 2 * m, out + 2 * h, 2 * hi);
+    add_into(out + h, 2 * n - h, z1, 2 * m);
+
+    free(scratch);
+}
+
+//out (na + nb limbs) = a * b
+static void mag_mul(uint32_t* out, const uint32_t* a, int na, const uint32_t* b, int nb) {
+    memset(out, 0, sizeof(uint32_t) * (size_t)(na + nb));
+    if (na < nb) {
+        const uint32_t* t = a; a = b; b = t;
+        int tn = na; na = nb; nb = tn;
+    }
+    if (nb < VALUE_KARATSUBA_THRESHOLD) {
+        mul_school(out, a, na, b, nb);
+        return;
+    }
+
+    //split the longer operand into nb-limb pieces so every product is balanced
+    uint32_t* piece = calloc((size_t)nb, sizeof(uint32_t));
+    uint32_t* product = malloc(sizeof(uint32_t) * 2 * (size_t)nb);
+    if (!piece || !product) {
+        fault_out_of_memory("big integer");
+    }
+
+    for (int off = 0; off < na; off += nb) {
+        int len = na - off < nb ? na - off : nb;
+        memset(piece, 0, sizeof(uint32_t) * nb);
+        memcpy(piece, a + off, sizeof(uint32_t) * len);
+        mul_karatsuba(product, piece, b, nb);
+        int span = na + nb - off;
+        add_into(out + off, span, product, 2 * nb < span ? 2 * nb : span);
+    }
+
+    free(piece);
+    free(product);
+}
+
+static uint32_t mag_div_small(uint32_t* q, const uint32_t* a, int na, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = na - 1; i >= 0; i--) {
+        uint64_t cur = (rem << 32) | a[i];
+        q[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    return (uint32_t)rem;
+}
+
+static int leading_zeros(uint32_t x) {
+    int n = 0;
+    while (!(x & 0x80000000u)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+//Knuth algorithm D: q gets m - n + 1 limbs, r gets n limbs, needs m >= n >= 2
+static void mag_divmod(uint32_t* q, uint32_t* r, const uint32_t* u, int m, const uint32_t* v, int n) {
+    const uint64_t base = (uint64_t)1 << 32;
+    int s = leading_zeros(v[n - 1]);
+
+    uint32_t* vn = malloc(sizeof(uint32_t) * (size_t)n);
+    uint32_t* un = malloc(sizeof(uint32_t) * (size_t)(m + 1));
+    if (!vn || !un) {
+        fault_out_of_memory("big integer");
+    }
+
+    for (int i = n - 1; i > 0; i--) {
+        vn[i] = (uint32_t)(((uint64_t)v[i] << s) | (s ? (uint64_t)v[i - 1] >> (32 - s) : 0));
+    }
+    vn[0] = v[0] << s;
+
+    un[m] = s ? (uint32_t)((uint64_t)u[m - 1] >> (32 - s)) : 0;
+    for (int i = m - 1; i > 0; i--) {
+        un[i] = (uint32_t)(((uint64_t)u[i] << s) | (s ? (uint64_t)u[i - 1] >> (32 - s) : 0));
+    }
+    un[0] = u[0] << s;
+
+    for (int j = m - n; j >= 0; j--) {
+        uint64_t num = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+        uint64_t qhat = num / vn[n - 1];
+        uint64_t rhat = num % vn[n - 1];
+
+        while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= base) break;
+        }
+
+        int64_t k = 0;
+        int64_t t;
+        for (int i = 0; i < n; i++) {
+            uint64_t p = qhat * vn[i];
+            t = (int64_t)un[i + j] - k - (int64_t)(p & 0xFFFFFFFFu);
+            un[i + j] = (uint32_t)t;
+            k = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)un[j + n] - k;
+        un[j + n] = (uint32_t)t;
+
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            q[j]--;
+            uint64_t carry = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                un[i + j] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            un[j + n] = (uint32_t)((uint64_t)un[j + n] + carry);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        r[i] = (uint32_t)(((uint64_t)un[i] >> s) | (s ? (uint64_t)un[i + 1] << (32 - s) : 0));
+    }
+
+    free(vn);
+    free(un);
+}
+
+static Value add_signed(Value a, Value b, int negate_b) {
+    if (value_is_fixnum(a) && value_is_fixnum(b)) {
+        intptr_t x = value_fixnum(a);
+        intptr_t y = value_fixnum(b);
+        intptr_t s = negate_b ? x - y : x + y;
+        if (s >= VALUE_FIXNUM_MIN && s <= VALUE_FIXNUM_MAX) return value_from_fixnum(s);
+        return value_from_long((long long)s);
+    }
+
+    Mag ma, mb;
+    mag_view(a, &ma);
+    mag_view(b, &mb);
+    int sb = negate_b ? -mb.sign : mb.sign;
+
+    if (mb.size == 0) return value_copy(a);
+    if (ma.size == 0) return negate_b ? value_neg(b) : value_copy(b);
+
+    int n = (ma.size > mb.size ? ma.size : mb.size) + 1;
+    BigInt* r = big_alloc(n);
+
+    if (ma.sign == sb) {
+        r->size = mag_add(r->limbs, ma.limbs, ma.size, mb.limbs, mb.size);
+        return finish(r, ma.sign);
+    }
+
+    int cmp = mag_cmp(ma.limbs, ma.size, mb.limbs, mb.size);
+    if (cmp >= 0) {
+        r->size = mag_sub(r->limbs, ma.limbs, ma.size, mb.limbs, mb.size);
+        return finish(r, ma.sign);
+    }
+    r->size = mag_sub(r->limbs, mb.limbs, mb.size, ma.limbs, ma.size);
+    return finish(r, sb);
+}
+
+Value value_add(Value a, Value b) {
+    return add_signed(a, b, 0);
+}
+
+Value value_sub(Value a, Value b) {
+    return add_signed(a, b, 1);
+}
+
+Value value_neg(Value a) {
+    //-VALUE_FIXNUM_MIN does not fit a fixnum and comes back as a bignum
+    if (value_is_fixnum(a)) return value_from_long(-(long long)value_fixnum(a));
+
+    BigInt* r = (BigInt*)value_copy(a);
+    return finish(r, -r->sign);
+}
+
+static int fixnum_mul(intptr_t a, intptr_t b, intptr_t* out) {
+    if (a == 0 || b == 0) {
+        *out = 0;
+        return 0;
+    }
+    intptr_t limit = VALUE_FIXNUM_MAX;
+    intptr_t abs_a = a < 0 ? -a : a;
+    intptr_t abs_b = b < 0 ? -b : b;
+    if (abs_a > limit / abs_b) return -1;
+    *out = a * b;
+    return 0;
+}
+
+Value value_mul(Value a, Value b) {
+    if (value_is_fixnum(a) && value_is_fixnum(b)) {
+        intptr_t p;
+        if (fixnum_mul(value_fixnum(a), value_fixnum(b), &p) == 0) return value_from_fixnum(p);
+    }
+
+    Mag ma, mb;
+    mag_view(a, &ma);
+    mag_view(b, &mb);
+    if (ma.size == 0 || mb.size == 0) return value_from_fixnum(0);
+
+    BigInt* r = big_alloc(ma.size + mb.size);
+    mag_mul(r->limbs, ma.limbs, ma.size, mb.limbs, mb.size);
+    return finish(r, ma.sign * mb.sign);
+}
+
+//truncating division, remainder takes the sign of the dividend
+int value_divmod(Value a, Value b, Value* quotient, Value* remainder) {
+    if (value_sign(b) == 0) return -1;
+
+    if (value_is_fixnum(a) && value_is_fixnum(b)) {
+        intptr_t x = value_fixnum(a);
+        intptr_t y = value_fixnum(b);
+        if (quotient) *quotient = value_from_long((long long)(x / y));
+        if (remainder) *remainder = value_from_fixnum(x % y);
+        return 0;
+    }
+
+    Mag ma, mb;
+    mag_view(a, &ma);
+    mag_view(b, &mb);
+
+    if (mag_cmp(ma.limbs, ma.size, mb.limbs, mb.size) < 0) {
+        if (quotient) *quotient = value_from_fixnum(0);
+        if (remainder) *remainder = value_copy(a);
+        return 0;
+    }
+
+    BigInt* q = big_alloc(ma.size - mb.size + 1);
+    BigInt* r = big_alloc(mb.size);
+
+    if (mb.size == 1) {
+        r->limbs[0] = mag_div_small(q->limbs, ma.limbs, ma.size, mb.limbs[0]);
+        q->size = ma.size;
+    } else {
+        mag_divmod(q->limbs, r->limbs, ma.limbs, ma.size, mb.limbs, mb.size);
+    }
+
+    Value qv = finish(q, ma.sign * mb.sign);
+    Value rv = finish(r, ma.sign);
+    if (quotient) *quotient = qv; else value_release(qv);
+    if (remainder) *remainder = rv; else value_release(rv);
+    return 0;
+}
+
+static Value value_abs(Value v) {
+    return value_sign(v) < 0 ? value_neg(v) : value_copy(v);
+}
+
+Value value_gcd(Value a, Value b) {
+    if (value_is_fixnum(a) && value_is_fixnum(b)) {
+        intptr_t x = value_fixnum(a);
+        intptr_t y = value_fixnum(b);
+        if (x < 0) x = -x;
+        if (y < 0) y = -y;
+        while (y) {
+            intptr_t t = x % y;
+            x = y;
+            y = t;
+        }
+        return value_from_long((long long)x);
+    }
+
+    Value x = value_abs(a);
+    Value y = value_abs(b);
+    while (value_sign(y) != 0) {
+        Value r;
+        value_divmod(x, y, NULL, &r);
+        value_release(x);
+        x = y;
+        y = r;
+    }
+    value_release(y);
+    return x;
+}
+
+int value_sign(Value v) {
+    if (value_is_fixnum(v)) {
+        intptr_t i = value_fixnum(v);
+        return i < 0 ? -1 : (i > 0);
+    }
+    return ((const BigInt*)v)->sign;
+}
+
+int value_cmp(Value a, Value b) {
+    if (value_is_fixnum(a) && value_is_fixnum(b)) {
+        intptr_t x = value_fixnum(a);
+        intptr_t y = value_fixnum(b);
+        return x < y ? -1 : (x > y);
+    }
+
+    Mag ma, mb;
+    mag_view(a, &ma);
+    mag_view(b, &mb);
+    if (ma.sign != mb.sign) return ma.sign < mb.sign ? -1 : 1;
+
+    int cmp = mag_cmp(ma.limbs, ma.size, mb.limbs, mb.size);
+    return ma.sign < 0 ? -cmp : cmp;
+}
+
+int value_to_long(Value v, long long* out) {
+    if (value_is_fixnum(v)) {
+        *out = (long long)value_fixnum(v);
+        return 0;
+    }
+
+    const BigInt* b = (const BigInt*)v;
+    if (b->size > 2) return -1;
+
+    unsigned long long u = b->size == 1 ? b->limbs[0] :
+                           ((unsigned long long)b->limbs[1] << 32) | b->limbs[0];
+    if (b->sign > 0 && u > 9223372036854775807ULL) return -1;
+    if (b->sign < 0 && u > 9223372036854775808ULL) return -1;
+
+    *out = b->sign < 0 ? (long long)(0ULL - u) : (long long)u;
+    return 0;
+}
+
+long long value_mod_long(Value v, long long m) {
+    long long r;
+    if (value_is_fixnum(v)) {
+        r = (long long)value_fixnum(v) % m;
+    } else {
+        Value modulus = value_from_long(m);
+        Value rem;
+        value_divmod(v, modulus, NULL, &rem);
+        value_to_long(rem, &r);
+        value_release(rem);
+        value_release(modulus);
+    }
+    return r < 0 ? r + m : r;
+}
+
+Value value_from_decimal(const char* digits, size_t len) {
+    if (len <= 18) {
+        long long n = 0;
+        for (size_t i = 0; i < len; i++) n = n * 10 + (digits[i] - '0');
+        return value_from_long(n);
+    }
+
+    //each limb holds at least nine decimal digits
+    int cap = (int)(len / 9) + 2;
+    BigInt* b = big_alloc(cap);
+    b->size = 0;
+
+    size_t pos = 0;
+    size_t first = len % 9 ? len % 9 : 9;
+    while (pos < len) {
+        size_t take = pos == 0 ? first : 9;
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t k = 0; k < take; k++) {
+            chunk = chunk * 10 + (uint32_t)(digits[pos + k] - '0');
+            scale *= 10;
+        }
+
+        uint64_t carry = chunk;
+        for (int i = 0; i < b->size; i++) {
+            uint64_t t = (uint64_t)b->limbs[i] * scale + carry;
+            b->limbs[i] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        if (carry) b->limbs[b->size++] = (uint32_t)carry;
+        pos += take;
+    }
+
+    return finish(b, 1);
+}
+
+int value_parse(const char* text, size_t len, Value* out) {
+    int negative = len > 0 && text[0] == '-';
+    const char* digits = text + negative;
+    size_t count = len - (size_t)negative;
+    if (count == 0) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (digits[i] < '0' || digits[i] > '9') return -1;
+    }
+
+    Value v = value_from_decimal(digits, count);
+    if (negative) {
+        *out = value_neg(v);
+        value_release(v);
+    } else {
+        *out = v;
+    }
+    return 0;
+}
+
+//room for the digits, sign and terminator of v
+static size_t decimal_size(Value v) {
+    Mag m;
+    mag_view(v, &m);
+    return (size_t)m.size * 10 + 3;
+}
+
+//v in decimal at out, which holds decimal_size(v) bytes; -1 if there is no work space
+static long write_decimal(Value v, char* out) {
+    Mag m;
+    mag_view(v, &m);
+
+    uint32_t* work = malloc(sizeof(uint32_t) * (size_t)(m.size > 0 ? m.size : 1));
+    if (!work) return -1;
+    memcpy(work, m.limbs, sizeof(uint32_t) * m.size);
+
+    size_t n = 0;
+    int size = m.size;
+    while (size > 0) {
+        uint32_t rem = mag_div_small(work, work, size, 1000000000u);
+        while (size > 0 && work[size - 1] == 0) size--;
+        for (int d = 0; d < 9 && (size > 0 || rem > 0); d++) {
+            out[n++] = (char)('0' + rem % 10);
+            rem /= 10;
+        }
+    }
+    if (n == 0) out[n++] = '0';
+    if (m.sign < 0) out[n++] = '-';
+    out[n] = '\0';
+
+    for (size_t i = 0; i < n / 2; i++) {
+        char t = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = t;
+    }
+
+    free(work);
+    return (long)n;
+}
+
+char* value_to_string(Value v) {
+    char* out = malloc(decimal_size(v));
+    if (!out || write_decimal(v, out) < 0) {
+        free(out);
+        fault_out_of_memory("number text");
+    }
+    return out;
+}
+
+static int is_one(Value v) {
+    return value_is_fixnum(v) && value_fixnum(v) == 1;
+}
+
+//takes ownership of num and den
+static Rational normalize(Value num, Value den) {
+    Rational r;
+
+    if (value_sign(den) < 0) {
+        Value n2 = value_neg(num);
+        Value d2 = value_neg(den);
+        value_release(num);
+        value_release(den);
+        num = n2;
+        den = d2;
+    }
+
+    if (!is_one(den)) {
+        Value g = value_gcd(num, den);
+        if (!is_one(g)) {
+            Value n2, d2;
+            value_divmod(num, g, &n2, NULL);
+            value_divmod(den, g, &d2, NULL);
+            value_release(num);
+            value_release(den);
+            num = n2;
+            den = d2;
+        }
+        value_release(g);
+    }
+
+    r.num = num;
+    r.den = den;
+    return r;
+}
+
+Rational rational_from_value(Value v) {
+    Rational r;
+    r.num = value_copy(v);
+    r.den = value_from_fixnum(1);
+    return r;
+}
+
+Rational rational_copy(Rational r) {
+    Rational c;
+    c.num = value_copy(r.num);
+    c.den = value_copy(r.den);
+    return c;
+}
+
+void rational_release(Rational r) {
+    value_release(r.num);
+    value_release(r.den);
+}
+
+int rational_is_integer(Rational r) {
+    return is_one(r.den);
+}
+
+static Rational add_rational(Rational a, Rational b, int negate_b) {
+    if (is_one(a.den) && is_one(b.den)) {
+        Rational r;
+        r.num = negate_b ? value_sub(a.num, b.num) : value_add(a.num, b.num);
+        r.den = value_from_fixnum(1);
+        return r;
+    }
+
+    Value x = value_mul(a.num, b.den);
+    Value y = value_mul(b.num, a.den);
+    Value num = negate_b ? value_sub(x, y) : value_add(x, y);
+    value_release(x);
+    value_release(y);
+    return normalize(num, value_mul(a.den, b.den));
+}
+
+Rational rational_add(Rational a, Rational b) {
+    return add_rational(a, b, 0);
+}
+
+Rational rational_sub(Rational a, Rational b) {
+    return add_rational(a, b, 1);
+}
+
+Rational rational_mul(Rational a, Rational b) {
+    if (is_one(a.den) && is_one(b.den)) {
+        Rational r;
+        r.num = value_mul(a.num, b.num);
+        r.den = value_from_fixnum(1);
+        return r;
+    }
+    return normalize(value_mul(a.num, b.num), value_mul(a.den, b.den));
+}
+
+Rational rational_neg(Rational a) {
+    Rational r;
+    r.num = value_neg(a.num);
+    r.den = value_copy(a.den);
+    return r;
+}
+
+int rational_div(Rational a, Rational b, Rational* out) {
+    if (value_sign(b.num) == 0) return -1;
+    *out = normalize(value_mul(a.num, b.den), value_mul(a.den, b.num));
+    return 0;
+}
+
+int rational_cmp(Rational a, Rational b) {
+    if (is_one(a.den) && is_one(b.den)) return value_cmp(a.num, b.num);
+
+    Value x = value_mul(a.num, b.den);
+    Value y = value_mul(b.num, a.den);
+    int cmp = value_cmp(x, y);
+    value_release(x);
+    value_release(y);
+    return cmp;
+}
+
+//both halves go into one buffer, so nothing is left behind when the second one faults
+char* rational_to_string(Rational r) {
+    if (is_one(r.den)) return value_to_string(r.num);
+
+    char* out = malloc(decimal_size(r.num) + decimal_size(r.den));
+    long n = out ? write_decimal(r.num, out) : -1;
+    if (n >= 0) {
+        out[n++] = '/';
+        n = write_decimal(r.den, out + n);
+    }
+    if (n < 0) {
+        free(out);
+        fault_out_of_memory("number text");
+    }
+    return out;
+}
@@ -0,0 +1,70 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//tagged integer: odd words are immediate fixnums, even words point to a heap bignum
+typedef uintptr_t Value;
+
+#define VALUE_FIXNUM_MAX (INTPTR_MAX >> 1)
+#define VALUE_FIXNUM_MIN (-VALUE_FIXNUM_MAX - 1)
+#define VALUE_KARATSUBA_THRESHOLD 32
+
+static inline int value_is_fixnum(Value v) {
+    return (int)(v & 1);
+}
+
+static inline intptr_t value_fixnum(Value v) {
+    return (intptr_t)v >> 1;
+}
+
+static inline Value value_from_fixnum(intptr_t i) {
+    return ((uintptr_t)i << 1) | 1;
+}
+
+Value value_from_long(long long n);
+Value value_from_decimal(const char* digits, size_t len);
+
+//a whole decimal integer with an optional '-'; -1 if text is anything else
+int value_parse(const char* text, size_t len, Value* out);
+Value value_copy(Value v);
+//0 is never a value, so releasing it does nothing, like free(NULL)
+void value_release(Value v);
+
+Value value_add(Value a, Value b);
+Value value_sub(Value a, Value b);
+Value value_mul(Value a, Value b);
+Value value_neg(Value a);
+int value_divmod(Value a, Value b, Value* quotient, Value* remainder);
+Value value_gcd(Value a, Value b);
+
+int value_sign(Value v);
+int value_cmp(Value a, Value b);
+int value_to_long(Value v, long long* out);
+
+//v reduced into [0, m) for a positive word-size modulus
+long long value_mod_long(Value v, long long m);
+char* value_to_string(Value v);
+
+//exact rational with positive denominator and gcd(num, den) == 1
+typedef struct {
+    Value num;
+    Value den;
+} Rational;
+
+Rational rational_from_value(Value v);
+Rational rational_copy(Rational r);
+void rational_release(Rational r);
+
+Rational rational_add(Rational a, Rational b);
+Rational rational_sub(Rational a, Rational b);
+Rational rational_mul(Rational a, Rational b);
+Rational rational_neg(Rational a);
+int rational_div(Rational a, Rational b, Rational* out);
+
+int rational_cmp(Rational a, Rational b);
+int rational_is_integer(Rational r);
+char* rational_to_string(Rational r);
+
+#endif
@@ -0,0 +1,259 @@
+//packed coefficient storage at every element width, and coeff_matrix_rank over each kind
+//of ring against a fraction-free elimination on Values
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "linalg.h"
+
+static unsigned long long state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long long random_word(void) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+//v mod m in [0, m)
+static Value value_mod(Value v, Value m) {
+    Value r;
+    value_divmod(v, m, NULL, &r);
+    if (value_sign(r) < 0) {
+        Value t = value_add(r, m);
+        value_release(r);
+        r = t;
+    }
+    return r;
+}
+
+//uniform enough below m, or in [-3, 3] over Z
+static Value random_entry(Value m) {
+    if (!m) return value_from_long((long long)(random_word() % 7) - 3);
+
+    Value shift = value_from_long(1LL << 32);
+    Value v = value_from_fixnum(0);
+    for (int i = 0; i < 4; i++) {
+        Value scaled = value_mul(v, shift);
+        Value digit = value_from_long((long long)(random_word() >> 32));
+        value_release(v);
+        v = value_add(scaled, digit);
+        value_release(scaled);
+        value_release(digit);
+    }
+    value_release(shift);
+
+    Value r = value_mod(v, m);
+    value_release(v);
+    return r;
+}
+
+static void release_all(Value* a, int count) {
+    for (int i = 0; i < count; i++) value_release(a[i]);
+    free(a);
+}
+
+//a rows x cols matrix of rank at most inner, as a product of two random ones
+static Value* random_matrix(int rows, int cols, int inner, Value m) {
+    Value* left = malloc(sizeof(Value) * rows * inner);
+    Value* right = malloc(sizeof(Value) * inner * cols);
+    Value* a = malloc(sizeof(Value) * rows * cols);
+    for (int i = 0; i < rows * inner; i++) left[i] = random_entry(m);
+    for (int i = 0; i < inner * cols; i++) right[i] = random_entry(m);
+
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            Value sum = value_from_fixnum(0);
+            for (int t = 0; t < inner; t++) {
+                Value product = value_mul(left[i * inner + t], right[t * cols + j]);
+                Value next = value_add(sum, product);
+                value_release(sum);
+                value_release(product);
+                sum = next;
+            }
+            if (m) {
+                a[i * cols + j] = value_mod(sum, m);
+                value_release(sum);
+            } else {
+                a[i * cols + j] = sum;
+            }
+        }
+    }
+
+    release_all(left, rows * inner);
+    release_all(right, inner * cols);
+    return a;
+}
+
+//row r becomes pivot*row r - f*pivot row, which keeps the rank when every nonzero
+//pivot is a unit; consumes a
+static int reference_rank(Value* a, int rows, int cols, Value m) {
+    int rank = 0;
+    for (int c = 0; c < cols && rank < rows; c++) {
+        int pivot = -1;
+        for (int r = rank; r < rows && pivot < 0; r++) {
+            if (value_sign(a[r * cols + c]) != 0) pivot = r;
+        }
+        if (pivot < 0) continue;
+
+        for (int j = 0; j < cols; j++) {
+            Value t = a[pivot * cols + j];
+            a[pivot * cols + j] = a[rank * cols + j];
+            a[rank * cols + j] = t;
+        }
+        Value* prow = a + rank * cols;
+        for (int r = rank + 1; r < rows; r++) {
+            Value* row = a + r * cols;
+            Value f = value_copy(row[c]);
+            for (int j = c; j < cols; j++) {
+                Value x = value_mul(prow[c], row[j]);
+                Value y = value_mul(f, prow[j]);
+                value_release(row[j]);
+                row[j] = value_sub(x, y);
+                value_release(x);
+                value_release(y);
+                if (m) {
+                    Value t = value_mod(row[j], m);
+                    value_release(row[j]);
+                    row[j] = t;
+                }
+            }
+            value_release(f);
+        }
+        rank++;
+    }
+
+    release_all(a, rows * cols);
+    return rank;
+}
+
+//moduli up to 2^63 go in through coeff_set at the width the parser would pick, larger
+//ones as Montgomery limbs
+static int check_rank(const char* modulus, int rows, int cols, int inner) {
+    Value m = 0;
+    long long small = 0;
+    MontContext ctx;
+    int mont = 0;
+    if (modulus) {
+        m = value_from_decimal(modulus, strlen(modulus));
+        if (value_to_long(m, &small) != 0) {
+            mont = 1;
+            small = 0;
+            if (mont_init(&ctx, modulus, strlen(modulus)) != 0) {
+                printf("FAIL modulus %s rejected\n", modulus);
+                value_release(m);
+                return 1;
+            }
+        }
+    }
+
+    Value* a = random_matrix(rows, cols, inner, m);
+    int width = mont ? ctx.limbs * (int)sizeof(limb_t) : coeff_width_for_modulus(small);
+    CoeffMatrix packed;
+    if (coeff_matrix_init(&packed, rows, cols, width, !modulus) != 0) {
+        printf("FAIL %dx%d matrix of %d-byte entries\n", rows, cols, width);
+        release_all(a, rows * cols);
+        if (m) value_release(m);
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            Value v = a[i * cols + j];
+            if (mont) {
+                mont_from_value(&ctx, coeff_limbs(&packed, i, j), v);
+                continue;
+            }
+            long long n = 0;
+            value_to_long(v, &n);
+            coeff_set(&packed, i, j, n);
+            if (coeff_get(&packed, i, j) != n && !failed) {
+                failed = printf("FAIL %d-byte entry %lld read back as %lld\n", width, n, coeff_get(&packed, i, j));
+            }
+        }
+    }
+
+    int expected = reference_rank(a, rows, cols, m);
+    int rank = coeff_matrix_rank(&packed, rows, small, mont ? &ctx : NULL);
+    if (rank != expected) {
+        failed = printf("FAIL rank of %dx%d over Z/%s is %d, expected %d\n", rows, cols, modulus ? modulus : "0",
+                        rank, expected);
+    }
+    if (!failed) {
+        printf("rank of %dx%d over %s%s with %d-byte entries: %d\n", rows, cols, modulus ? "Z/" : "Z",
+               modulus ? modulus : "", width, rank);
+    }
+
+    coeff_matrix_free(&packed);
+    if (m) value_release(m);
+    return failed != 0;
+}
+
+//the extremes of each width survive a round trip without touching their neighbours,
+//and every row starts on a cache line
+static int check_widths(void) {
+    static const struct { int width; int is_signed; long long low; long long high; } cases[] = {
+        {1, 0, 0, 255},
+        {2, 0, 0, 65535},
+        {4, 0, 0, 4294967295LL},
+        {4, 1, -2147483647LL - 1, 2147483647LL},
+        {8, 0, -9223372036854775807LL - 1, 9223372036854775807LL},
+    };
+    int failed = 0;
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        CoeffMatrix m;
+        if (coeff_matrix_init(&m, 3, 5, cases[k].width, cases[k].is_signed) != 0) {
+            printf("FAIL %d-byte matrix\n", cases[k].width);
+            failed = 1;
+            continue;
+        }
+        for (int r = 0; r < 3; r++) {
+            if ((uintptr_t)coeff_row(&m, r) % COEFF_ALIGNMENT != 0) {
+                failed = printf("FAIL %d-byte row %d is not aligned\n", cases[k].width, r);
+            }
+        }
+        coeff_set(&m, 1, 2, cases[k].high);
+        coeff_set(&m, 1, 3, cases[k].low);
+        coeff_set(&m, 1, 4, cases[k].high);
+        if (coeff_get(&m, 1, 2) != cases[k].high || coeff_get(&m, 1, 3) != cases[k].low ||
+            coeff_get(&m, 1, 4) != cases[k].high || coeff_get(&m, 1, 1) != 0 || coeff_get(&m, 0, 4) != 0 ||
+            coeff_get(&m, 2, 0) != 0) {
+            failed = printf("FAIL %d-byte %s round trip\n", cases[k].width, cases[k].is_signed ? "signed" : "unsigned");
+        }
+        coeff_matrix_free(&m);
+    }
+
+    static const struct { long long modulus; int width; } moduli[] = {
+        {2, 1}, {256, 1}, {257, 2}, {65536, 2}, {65537, 4}, {4294967296LL, 4}, {4294967297LL, 8},
+        {9223372036854775783LL, 8}, {0, 4},
+    };
+    for (size_t k = 0; k < sizeof(moduli) / sizeof(moduli[0]); k++) {
+        if (coeff_width_for_modulus(moduli[k].modulus) != moduli[k].width) {
+            failed = printf("FAIL width for modulus %lld is %d\n", moduli[k].modulus,
+                            coeff_width_for_modulus(moduli[k].modulus));
+        }
+    }
+
+    if (!failed) printf("round trips and widths at 1, 2, 4 and 8 bytes: ok\n");
+    return failed != 0;
+}
+
+int main(void) {
+    static const char* moduli[] = {
+        "2", "7", "251", "257", "65521", "65537", "4294967291", "4294967311", "9223372036854775783",
+        "170141183460469231731687303715884105727",
+    };
+    int failed = check_widths();
+
+    for (size_t k = 0; k < sizeof(moduli) / sizeof(moduli[0]); k++) {
+        failed |= check_rank(moduli[k], 12, 10, 6);
+        failed |= check_rank(moduli[k], 9, 9, 9);
+        failed |= check_rank(moduli[k], 20, 31, 17);
+    }
+    failed |= check_rank(NULL, 4, 5, 3);
+    failed |= check_rank(NULL, 5, 5, 5);
+
+    return failed;
+}
@@ -0,0 +1,161 @@
+//faults during calls: each allocation of an evaluation and a normal form is made to fail
+//in turn, and the fault must come back as an error with no region left current and
+//nothing left allocated, neither region memory nor the scratch of the call.
+//Replaces malloc through glibc's __libc_ entry points to count and fail allocations
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "syzygy.h"
+#include "region.h"
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* p, size_t size);
+extern void __libc_free(void* p);
+
+//counting is on only between syz_create and syz_destroy, so stdio buffers stay out of it
+static int counting;
+static long live;
+static long requests;
+static long fail_at;
+
+static int refuse(void) {
+    return counting && ++requests == fail_at;
+}
+
+void* malloc(size_t size) {
+    if (refuse()) return NULL;
+    void* p = __libc_malloc(size);
+    if (p && counting) live++;
+    return p;
+}
+
+void* calloc(size_t count, size_t size) {
+    if (refuse()) return NULL;
+    void* p = __libc_calloc(count, size);
+    if (p && counting) live++;
+    return p;
+}
+
+void* realloc(void* p, size_t size) {
+    if (!p) return malloc(size);
+    if (refuse()) return NULL;
+    return __libc_realloc(p, size);
+}
+
+void free(void* p) {
+    if (p && counting) live--;
+    __libc_free(p);
+}
+
+//nested calls that build tuples and big integers in their regions, and a module whose
+//normal forms need the call's scratch vector
+static const char* source =
+    "ring F = integers_mod 7;\n"
+    "module V = free_module(F, 3);\n"
+    "generators { a = (1, 0, 0) in V; b = (0, 1, 0) in V; c = (0, 0, 1) in V; }\n"
+    "relations { a + 2*b == 0; c == 3*a; }\n"
+    "define grow as n . case n of { 0 -> (1, 2); _ -> (grow(n - 1), n * 100000000000000000000); };\n"
+    "define twice as n . (grow(n), grow(n));\n";
+
+static const char* expression = "twice(4)";
+static const long long vector[] = {1, 1, 0};
+
+typedef struct {
+    char* value;
+    char* normal_form;
+    int errors;
+} Outcome;
+
+static void discard(void* user, const char* text, size_t len) {
+    (void)user;
+    (void)text;
+    (void)len;
+}
+
+static char* keep(char* text) {
+    char* copy = text ? strcpy(__libc_malloc(strlen(text) + 1), text) : NULL;
+    syz_free(text);
+    return copy;
+}
+
+//the failure-th allocation of the two calls fails, none when failure is 0; returns 0
+//when the calls never got that far
+static int run(long failure, Outcome* out) {
+    counting = 1;
+    live = 0;
+    requests = 0;
+    fail_at = 0;
+
+    SyzContext* ctx = syz_create();
+    if (!ctx || syz_load(ctx, source, strlen(source)) != SYZ_OK) {
+        counting = 0;
+        printf("FAIL source did not load\n");
+        exit(1);
+    }
+    syz_set_output(ctx, discard, NULL);
+
+    fail_at = failure > 0 ? requests + failure : 0;
+    out->errors = 0;
+    out->value = keep(syz_evaluate(ctx, expression));
+    if (!out->value) out->errors++;
+    out->normal_form = keep(syz_normal_form(ctx, syz_find_module(ctx, "V"), vector));
+    if (!out->normal_form) out->errors++;
+    int reached = failure == 0 || requests >= fail_at;
+
+    if (region_current() != NULL) {
+        counting = 0;
+        printf("FAIL region still current after failure %ld\n", failure);
+        exit(1);
+    }
+
+    //the context keeps working after a fault
+    fail_at = 0;
+    syz_free(syz_evaluate(ctx, expression));
+    syz_free(syz_normal_form(ctx, syz_find_module(ctx, "V"), vector));
+    syz_destroy(ctx);
+    counting = 0;
+
+    if (live != 0) {
+        printf("FAIL %ld block(s) left allocated after failure %ld\n", live, failure);
+        exit(1);
+    }
+    return reached;
+}
+
+static int same_text(const char* a, const char* b) {
+    return !a || strcmp(a, b) == 0;
+}
+
+int main(void) {
+    Outcome expected;
+    run(0, &expected);
+    if (expected.errors) {
+        printf("FAIL the calls did not succeed without failures\n");
+        return 1;
+    }
+    printf("%s = %s\n", expression, expected.value);
+    printf("a + b = %s\n", expected.normal_form);
+
+    int failed = 0;
+    long failures = 0;
+    for (long n = 1;; n++) {
+        Outcome got;
+        int reached = run(n, &got);
+        //a failed allocation that is recovered from must still give the right answers
+        if (!same_text(got.value, expected.value) || !same_text(got.normal_form, expected.normal_form) ||
+            (!reached && got.errors)) {
+            failed = printf("FAIL wrong result after failure %ld\n", n);
+        }
+        __libc_free(got.value);
+        __libc_free(got.normal_form);
+        if (!reached || failed) break;
+        failures++;
+    }
+    if (!failed && failures <= 20) failed = printf("FAIL only %ld allocation(s) exercised\n", failures);
+    if (!failed) printf("each allocation failed in turn: no region left current, nothing left allocated\n");
+
+    __libc_free(expected.value);
+    __libc_free(expected.normal_form);
+    return failed != 0;
+}
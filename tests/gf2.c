@@ -0,0 +1,164 @@
+//the Four Russians kernels against schoolbook elimination and multiplication, with the
+//portable xor and, where the CPU has it, the AVX2 one
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gf2.h"
+
+static unsigned long long state = 0x9E3779B97F4A7C15ULL;
+
+static int random_bit(void) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (int)((state * 0x2545F4914F6CDD1DULL) >> 63);
+}
+
+//one byte per entry, row-major
+static unsigned char* random_bytes(int rows, int cols) {
+    unsigned char* a = malloc((size_t)(rows > 0 ? rows : 1) * (cols > 0 ? cols : 1));
+    for (int i = 0; i < rows * cols; i++) a[i] = (unsigned char)random_bit();
+    return a;
+}
+
+static unsigned char* multiply_bytes(const unsigned char* a, const unsigned char* b, int n, int m, int p) {
+    unsigned char* c = calloc((size_t)(n > 0 ? n : 1) * (p > 0 ? p : 1), 1);
+    for (int i = 0; i < n; i++) {
+        for (int t = 0; t < m; t++) {
+            if (!a[i * m + t]) continue;
+            for (int j = 0; j < p; j++) c[i * p + j] ^= b[t * p + j];
+        }
+    }
+    return c;
+}
+
+//reduced row echelon form in place; returns the rank
+static int reduce_bytes(unsigned char* a, int rows, int cols) {
+    int r = 0;
+    for (int c = 0; c < cols && r < rows; c++) {
+        int pivot = -1;
+        for (int i = r; i < rows && pivot < 0; i++) {
+            if (a[i * cols + c]) pivot = i;
+        }
+        if (pivot < 0) continue;
+
+        for (int j = 0; j < cols; j++) {
+            unsigned char t = a[pivot * cols + j];
+            a[pivot * cols + j] = a[r * cols + j];
+            a[r * cols + j] = t;
+        }
+        for (int i = 0; i < rows; i++) {
+            if (i == r || !a[i * cols + c]) continue;
+            for (int j = 0; j < cols; j++) a[i * cols + j] ^= a[r * cols + j];
+        }
+        r++;
+    }
+    return r;
+}
+
+static void load(GF2Matrix* m, const unsigned char* a, int rows, int cols) {
+    gf2_matrix_init(m, rows, cols);
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) gf2_set(m, i, j, a[i * cols + j]);
+    }
+}
+
+static int same(const GF2Matrix* m, const unsigned char* a, int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            if (gf2_get(m, i, j) != a[i * cols + j]) return 0;
+        }
+    }
+    return 1;
+}
+
+static const char* kernels[] = {"portable", "avx2"};
+
+static int check_multiply(int n, int m, int p) {
+    unsigned char* a = random_bytes(n, m);
+    unsigned char* b = random_bytes(m, p);
+    unsigned char* expected = multiply_bytes(a, b, n, m, p);
+
+    int failed = 0;
+    for (int k = 0; k < 2; k++) {
+        GF2XorFn xor_fn = gf2_xor_kernel(kernels[k]);
+        if (!xor_fn) continue;
+
+        GF2Matrix ma, mb, mc;
+        load(&ma, a, n, m);
+        load(&mb, b, m, p);
+        if (gf2_multiply(&mc, &ma, &mb, xor_fn) != 0 || !same(&mc, expected, n, p)) {
+            printf("FAIL multiply %dx%d by %dx%d with %s\n", n, m, m, p, kernels[k]);
+            failed = 1;
+        } else {
+            gf2_matrix_free(&mc);
+        }
+        gf2_matrix_free(&ma);
+        gf2_matrix_free(&mb);
+    }
+    if (!failed) printf("multiply %dx%d by %dx%d: ok\n", n, m, m, p);
+
+    free(a);
+    free(b);
+    free(expected);
+    return failed;
+}
+
+//a rows x cols matrix of rank at most inner, as a product of two random ones
+static int check_echelonize(int rows, int cols, int inner) {
+    unsigned char* left = random_bytes(rows, inner);
+    unsigned char* right = random_bytes(inner, cols);
+    unsigned char* a = multiply_bytes(left, right, rows, inner, cols);
+    unsigned char* expected = malloc((size_t)rows * cols + 1);
+    memcpy(expected, a, (size_t)rows * cols);
+    int rank = reduce_bytes(expected, rows, cols);
+
+    int failed = 0;
+    for (int k = 0; k < 2; k++) {
+        GF2XorFn xor_fn = gf2_xor_kernel(kernels[k]);
+        if (!xor_fn) continue;
+
+        GF2Matrix m;
+        load(&m, a, rows, cols);
+        if (gf2_echelonize(&m, 1, xor_fn) != rank || !same(&m, expected, rows, cols)) {
+            printf("FAIL reduced echelon form of %dx%d with %s\n", rows, cols, kernels[k]);
+            failed = 1;
+        }
+        gf2_matrix_free(&m);
+
+        load(&m, a, rows, cols);
+        if (gf2_echelonize(&m, 0, xor_fn) != rank) {
+            printf("FAIL rank of %dx%d with %s\n", rows, cols, kernels[k]);
+            failed = 1;
+        }
+        gf2_matrix_free(&m);
+    }
+    if (!failed) printf("echelonize %dx%d of rank %d: ok\n", rows, cols, rank);
+
+    free(left);
+    free(right);
+    free(a);
+    free(expected);
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+
+    failed |= check_multiply(1, 1, 1);
+    failed |= check_multiply(3, 5, 7);
+    failed |= check_multiply(64, 64, 64);
+    failed |= check_multiply(65, 130, 67);
+    failed |= check_multiply(100, 9, 300);
+    failed |= check_multiply(257, 300, 129);
+
+    failed |= check_echelonize(1, 1, 1);
+    failed |= check_echelonize(10, 20, 10);
+    failed |= check_echelonize(64, 64, 64);
+    failed |= check_echelonize(200, 130, 130);
+    failed |= check_echelonize(130, 200, 130);
+    failed |= check_echelonize(300, 300, 40);
+    failed |= check_echelonize(70, 500, 3);
+
+    return failed;
+}
@@ -0,0 +1,10 @@
+#import_cached.sz twice through one cache: the second run loads the library from its
+#unit entry, definitions included, and must print the same apart from "(cached)"
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+SYZYGY_CACHE_DIR=$dir $SYZYGY tests/import_cached.sz > "$dir/first"
+cat "$dir/first"
+
+echo "== from the cache"
+SYZYGY_CACHE_DIR=$dir $SYZYGY tests/import_cached.sz | diff "$dir/first" -
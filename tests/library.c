@@ -0,0 +1,156 @@
+//the embedding API: queries and structured errors from one context, then the same
+//answers from two contexts at a time on each of several threads
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "syzygy.h"
+
+#define THREADS 4
+#define ROUNDS 25
+
+static const char* source =
+    "ring F = integers_mod 7;\n"
+    "ring Z = integers;\n"
+    "module V = free_module(F, 3);\n"
+    "generators { a = (1, 0, 0) in V; b = (0, 1, 0) in V; c = (0, 0, 1) in V; }\n"
+    "relations { a + 2*b == 0; c == 3*a; }\n"
+    "module A = free_module(Z, 2);\n"
+    "generators { x = (1, 0) in A; y = (0, 1) in A; }\n"
+    "relations { 4*x + 6*y == 0; 2*y == 0; }\n"
+    "define square as n . n * n;\n"
+    "define k as square(12);\n";
+
+//the second line names a ring that was never declared
+static const char* bad_source =
+    "ring G = integers_mod 5;\n"
+    "module M = free_module(H, 2);\n";
+
+typedef struct {
+    char* summary;
+    char* normal_form;
+    char* cokernel;
+    char* value;
+    SyzError error;
+    int rings_after_error;
+} Answers;
+
+static void discard(void* user, const char* text, size_t len) {
+    (void)user;
+    (void)text;
+    (void)len;
+}
+
+static SyzContext* load(void) {
+    SyzContext* ctx = syz_create();
+    if (!ctx) return NULL;
+    syz_set_output(ctx, discard, NULL);
+    if (syz_load(ctx, source, strlen(source)) != SYZ_OK) {
+        syz_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void answer(SyzContext* ctx, Answers* out) {
+    static const long long a[] = {1, 0, 0};
+    int v = syz_find_module(ctx, "V");
+
+    out->summary = syz_module_summary(ctx, v);
+    out->normal_form = syz_normal_form(ctx, v, a);
+    out->cokernel = syz_cokernel(ctx, syz_find_module(ctx, "A"));
+    out->value = syz_evaluate(ctx, "k + square(3)");
+
+    syz_load(ctx, bad_source, strlen(bad_source));
+    out->error = *syz_last_error(ctx);
+    out->rings_after_error = syz_ring_count(ctx);
+}
+
+static void release(Answers* a) {
+    syz_free(a->summary);
+    syz_free(a->normal_form);
+    syz_free(a->cokernel);
+    syz_free(a->value);
+}
+
+static int same_text(const char* a, const char* b) {
+    return a && b && strcmp(a, b) == 0;
+}
+
+static int same(const Answers* a, const Answers* b) {
+    return same_text(a->summary, b->summary) && same_text(a->normal_form, b->normal_form) &&
+           same_text(a->cokernel, b->cokernel) && same_text(a->value, b->value) &&
+           a->error.status == b->error.status && a->error.line == b->error.line &&
+           a->error.column == b->error.column && strcmp(a->error.message, b->error.message) == 0 &&
+           a->rings_after_error == b->rings_after_error;
+}
+
+static Answers expected;
+
+//two live contexts per round, answered in an interleaving each thread varies
+static void* run(void* arg) {
+    long id = (long)arg;
+    long mismatches = 0;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        SyzContext* first = load();
+        SyzContext* second = load();
+        if (!first || !second) {
+            mismatches++;
+        } else {
+            Answers x, y;
+            if ((round + id) % 2) {
+                answer(second, &y);
+                answer(first, &x);
+            } else {
+                answer(first, &x);
+                answer(second, &y);
+            }
+            if (!same(&x, &expected) || !same(&y, &expected)) mismatches++;
+            release(&x);
+            release(&y);
+        }
+        syz_destroy(first);
+        syz_destroy(second);
+    }
+    return (void*)mismatches;
+}
+
+int main(void) {
+    SyzContext* ctx = load();
+    if (!ctx) {
+        printf("FAIL source did not load\n");
+        return 1;
+    }
+    answer(ctx, &expected);
+    syz_destroy(ctx);
+
+    printf("V: %s", expected.summary ? expected.summary : "(none)\n");
+    printf("a = %s\n", expected.normal_form ? expected.normal_form : "(none)");
+    printf("A: %s\n", expected.cokernel ? expected.cokernel : "(none)");
+    printf("k + square(3) = %s\n", expected.value ? expected.value : "(none)");
+    printf("bad source: status %d at %d:%d: %s\n", expected.error.status, expected.error.line,
+           expected.error.column, expected.error.message);
+    printf("rings kept after the error: %d\n", expected.rings_after_error);
+
+    pthread_t threads[THREADS];
+    int failed = 0;
+    for (long i = 0; i < THREADS; i++) {
+        if (pthread_create(&threads[i], NULL, run, (void*)i) != 0) {
+            printf("FAIL thread %ld did not start\n", i);
+            return 1;
+        }
+    }
+    for (int i = 0; i < THREADS; i++) {
+        void* mismatches;
+        pthread_join(threads[i], &mismatches);
+        if (mismatches) {
+            printf("FAIL thread %d: %ld round(s) differ\n", i, (long)mismatches);
+            failed = 1;
+        }
+    }
+    if (!failed) printf("%d threads with two contexts each, %d rounds: same answers\n", THREADS, ROUNDS);
+
+    release(&expected);
+    return failed;
+}
@@ -0,0 +1,139 @@
+//Montgomery arithmetic at every modulus width from 1 to MONT_MAX_LIMBS limbs, against
+//the same operations on Values reduced by division
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mont.h"
+
+#define TRIALS 4
+
+static unsigned long long state = 0x9E3779B97F4A7C15ULL;
+
+static limb_t random_limb(void) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+//limbs as one Value, most significant half-limb first
+static Value value_from_limbs(const limb_t* limbs, int count) {
+    Value shift = value_from_long(1LL << 32);
+    Value v = value_from_fixnum(0);
+    for (int i = count - 1; i >= 0; i--) {
+        for (int half = 1; half >= 0; half--) {
+            Value scaled = value_mul(v, shift);
+            Value digit = value_from_long((long long)((limbs[i] >> (32 * half)) & 0xffffffffULL));
+            value_release(v);
+            v = value_add(scaled, digit);
+            value_release(scaled);
+            value_release(digit);
+        }
+    }
+    value_release(shift);
+    return v;
+}
+
+//v mod m in [0, m)
+static Value value_mod(Value v, Value m) {
+    Value r;
+    value_divmod(v, m, NULL, &r);
+    if (value_sign(r) < 0) {
+        Value t = value_add(r, m);
+        value_release(r);
+        r = t;
+    }
+    return r;
+}
+
+static void load(const MontContext* ctx, limb_t* out, Value v) {
+    char* text = value_to_string(v);
+    mont_from_decimal(ctx, out, text, strlen(text));
+    free(text);
+}
+
+static int matches(const MontContext* ctx, const limb_t* a, Value expected) {
+    size_t size = (size_t)ctx->limbs * 20 + 2;
+    char* text = malloc(size);
+    char* want = value_to_string(expected);
+    int same = mont_to_decimal(ctx, a, text, size) == 0 && strcmp(text, want) == 0;
+    free(text);
+    free(want);
+    return same;
+}
+
+static int check_width(int used) {
+    limb_t limbs[MONT_MAX_LIMBS];
+    for (int i = 0; i < used; i++) limbs[i] = random_limb();
+    limbs[0] |= 1;
+    if (limbs[used - 1] == 0) limbs[used - 1] = 1;
+    if (used == 1 && limbs[0] < 3) limbs[0] = 3;
+
+    MontContext ctx;
+    if (mont_init_limbs(&ctx, limbs, used) != 0) {
+        printf("FAIL %d limb(s): modulus rejected\n", used);
+        return 1;
+    }
+
+    Value m = value_from_limbs(limbs, used);
+    int failed = 0;
+
+    for (int t = 0; t < TRIALS && !failed; t++) {
+        limb_t wide[MONT_MAX_LIMBS + 1];
+        for (int i = 0; i <= used; i++) wide[i] = random_limb();
+        Value x = value_from_limbs(wide, used + 1);
+        Value a = value_mod(x, m);
+        for (int i = 0; i <= used; i++) wide[i] = random_limb();
+        Value y = value_from_limbs(wide, used + 1);
+        Value b = value_mod(y, m);
+
+        limb_t ma[MONT_MAX_LIMBS], mb[MONT_MAX_LIMBS], out[MONT_MAX_LIMBS];
+        load(&ctx, ma, a);
+        load(&ctx, mb, b);
+
+        Value product = value_mul(a, b);
+        Value sum = value_add(a, b);
+        Value difference = value_sub(a, b);
+        Value expected_product = value_mod(product, m);
+        Value expected_sum = value_mod(sum, m);
+        Value expected_difference = value_mod(difference, m);
+
+        mont_mul(&ctx, out, ma, mb);
+        if (!matches(&ctx, out, expected_product)) failed = printf("FAIL %d limb(s): product\n", used);
+        mont_add(&ctx, out, ma, mb);
+        if (!matches(&ctx, out, expected_sum)) failed = printf("FAIL %d limb(s): sum\n", used);
+        mont_sub(&ctx, out, ma, mb);
+        if (!matches(&ctx, out, expected_difference)) failed = printf("FAIL %d limb(s): difference\n", used);
+
+        //a negative multi-word value is reduced the same way as by division
+        Value negative = value_neg(y);
+        mont_from_value(&ctx, out, negative);
+        Value expected_negative = value_mod(negative, m);
+        if (!matches(&ctx, out, expected_negative)) failed = printf("FAIL %d limb(s): negative value\n", used);
+
+        value_release(x);
+        value_release(y);
+        value_release(a);
+        value_release(b);
+        value_release(product);
+        value_release(sum);
+        value_release(difference);
+        value_release(expected_product);
+        value_release(expected_sum);
+        value_release(expected_difference);
+        value_release(negative);
+        value_release(expected_negative);
+    }
+
+    value_release(m);
+    return failed != 0;
+}
+
+int main(void) {
+    int failed = 0;
+    for (int used = 1; used <= MONT_MAX_LIMBS; used++) {
+        failed |= check_width(used);
+    }
+    if (!failed) printf("product, sum, difference and negative values at 1 to %d limbs: ok\n", MONT_MAX_LIMBS);
+    return failed;
+}
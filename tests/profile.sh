@@ -0,0 +1,12 @@
+#profile.sz with --profile: the call count of every construct in the flat profile, which
+#unlike the times does not change from run to run, and a check that each collapsed stack
+#line is a ';'-joined stack followed by a positive microsecond count
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+SYZYGY_CACHE_DIR= $SYZYGY --profile="$dir/stacks.folded" tests/profile.sz > "$dir/out"
+awk '/^Flat profile:/ { flat = 1; next } /^Collapsed/ { flat = 0 }
+     flat && $1 != "self" { name = $4; for (i = 5; i <= NF; i++) name = name " " $i; print $3 "  " name }' "$dir/out" | LC_ALL=C sort -k2
+
+echo "== collapsed stacks"
+awk '{ if ($NF !~ /^[1-9][0-9]*$/) bad++ } END { print (NR > 0 && !bad) ? "well-formed" : "malformed" }' "$dir/stacks.folded"
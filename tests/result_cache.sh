@@ -0,0 +1,21 @@
+#result_cache.sz three times through one cache: solved and stored, then every echelon
+#form and summary restored, then again with one relation changed and with every entry
+#truncated, which must both be solved afresh
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+SYZYGY_CACHE_DIR=$dir $SYZYGY tests/result_cache.sz > "$dir/first"
+cat "$dir/first"
+
+echo "== unchanged"
+SYZYGY_CACHE_DIR=$dir $SYZYGY tests/result_cache.sz | diff "$dir/first" -
+
+echo "== one relation changed"
+sed 's/3\*u1 == 2\*u2/3*u1 == 4*u2/' tests/result_cache.sz > "$dir/changed.sz"
+SYZYGY_CACHE_DIR=$dir $SYZYGY "$dir/changed.sz" | grep -A1 -e "^    U:" -e "Result cache"
+
+echo "== entries truncated"
+for entry in "$dir"/*.szr; do
+    head -c 40 "$entry" > "$dir/cut" && mv "$dir/cut" "$entry"
+done
+SYZYGY_CACHE_DIR=$dir $SYZYGY tests/result_cache.sz | diff "$dir/first" -
@@ -0,0 +1,41 @@
+#!/bin/sh
+#runs every tests/*.sz and compares what it prints with the matching .out file;
+#NAME.args holds extra command line flags and NAME.sh replaces the plain run.
+#Each tests/NAME.c is a unit test built into the directory given second, and is
+#compared with its .out file the same way
+syzygy=${1:-./syzygy}
+programs=${2:-bin/tests}
+failed=0
+
+compare() {
+    if printf '%s\n' "$2" | diff -u "$1.out" - > /dev/null; then
+        echo "ok   $1"
+    else
+        echo "FAIL $1"
+        printf '%s\n' "$2" | diff -u "$1.out" -
+        failed=1
+    fi
+}
+
+for sz in tests/*.sz; do
+    name=${sz%.sz}
+    [ -f "$name.out" ] || continue
+
+    if [ -f "$name.sh" ]; then
+        actual=$(SYZYGY=$syzygy sh "$name.sh" 2>&1)
+    else
+        args=""
+        [ -f "$name.args" ] && args=$(cat "$name.args")
+        actual=$(SYZYGY_CACHE_DIR= $syzygy $args "$sz" 2>&1)
+    fi
+    compare "$name" "$actual"
+done
+
+for c in tests/*.c; do
+    [ -f "$c" ] || continue
+    name=${c%.c}
+    actual=$("$programs/${name#tests/}" 2>&1)
+    compare "$name" "$actual"
+done
+
+exit $failed